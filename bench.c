@@ -0,0 +1,319 @@
+/*
+    bench.c
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+// Benchmark of the whole pipeline over a fixed matrix: for every
+// algorithm, initial state and size, gen_trace stores the trace,
+// sim_pag simulates it with every policy, page size and number of
+// frames, and calculate_ws goes over it. Every run is a separate
+// process, so its peak RSS is its own; the time of a run is the
+// best of several. One CSV row for each run of the matrix.
+//
+// The random numbers are the same in every run: random_order (RAN)
+// calls srand(0), the pivots of QRP go on with that sequence of
+// rand() (or with the default one, for ASC and DES), and every
+// system of sim_pag has its own generator for RANDOM, seeded with
+// 1 (sim_srand). So the faults and write backs of the CSV only
+// change when the code does, and the references per second can be
+// compared row by row from one version to the next.
+
+#define GEN_TRACE "./gen_trace_bench"
+#define SIM_PAG "./sim_pag_bench"
+#define CALCULATE_WS "./calculate_ws_bench"
+
+#define WS_PAGSZ "16"       // Parameters of calculate_ws
+#define WS_INTERVAL "1000"
+
+#define REPORT_BYTES 8192   // Beginning of the output of sim_pag
+                            // that is kept (the general report)
+
+static const char * algorithms[] = { "HEA", "MER", "QUI", "QRP", NULL };
+static const char * initial[] = { "RAN", "DES", NULL };
+static const char * sizes[] = { "1000", "5000", NULL };
+static const char * policies[] = { "RANDOM", "FIFO", "FIFO2CH", "LRU",
+                                   "CLOCK", "ARC", NULL };
+static const char * pagsizes[] = { "1", "16", NULL };
+static const char * numframes[] = { "16", "256", NULL };
+
+// Result of running a program
+
+typedef struct
+{
+    double seconds;     // Wall time (the best of the runs)
+    long maxrss;        // Peak resident set, in KB (the largest)
+    char report[REPORT_BYTES];  // Beginning of its output
+}
+srun;
+
+// Function that runs a program runs times and fills R
+// (-1 if it couldn't run or didn't end well)
+
+int run (char * const argv[], int runs, srun * R);
+
+// Function that takes a counter from the report of sim_pag
+// (the line that starts with label)
+
+unsigned long long report_counter (const srun * R, const char * label);
+
+// Function that prints one row of the CSV
+
+void print_row (FILE * csv, const char * component, const char * alg,
+                const char * ini, const char * size, const char * policy,
+                const char * pagsz, const char * frames,
+                unsigned long long refs, unsigned long long faults,
+                unsigned long long writebacks, const srun * R);
+
+int main (int argc, char * argv[])
+{
+    FILE * csv;         // Results
+    char dir[] = "/tmp/benchXXXXXX";   // Stored traces
+    char path[64];      // Trace of the current experiment
+    srun gen, sim, ws;  // Runs of the three programs
+    unsigned long long refs, faults, writebacks;  // Figures of sim_pag
+    int runs;           // Runs of every program (the best one counts)
+    int a, i, t, p, s, f;   // Array indexes
+    int opt, ok;
+
+    // Options:
+    //     -r n     runs of every program (3)
+    //     -o file  write the CSV in file (by default, stdout)
+
+    csv = stdout;
+    runs = 3;
+
+    while ((opt=getopt(argc,argv,"o:r:")) != -1)
+    {
+        if (opt=='r' && sscanf(optarg,"%d",&runs)==1 && runs>0)
+            ;
+        else if (opt=='o' && (csv=fopen(optarg,"w")) != NULL)
+            ;
+        else
+        {
+            if (opt=='o')
+                perror (optarg);
+
+            fprintf (stderr, "USAGE: %s [-r runs] [-o file.csv]\n",
+                             argv[0]);
+            return -1;
+        }
+    }
+
+    if (!mkdtemp(dir))
+    {
+        perror ("ERROR creating the directory of the traces");
+        return -1;
+    }
+
+    fprintf (csv, "component,algorithm,initial,size,policy,pagsz,"
+                  "frames,refs,faults,writebacks,seconds,refs_per_s,"
+                  "maxrss_kb\n");
+
+    ok = 1;
+
+    for (a=0; ok && algorithms[a]; a++)
+        for (i=0; ok && initial[i]; i++)
+            for (t=0; ok && sizes[t]; t++)
+            {
+                char * gen_argv[] = { GEN_TRACE, "-b", "-o", path,
+                                      (char*)algorithms[a],
+                                      (char*)initial[i],
+                                      (char*)sizes[t], NULL };
+                char * ws_argv[] = { CALCULATE_WS, "-f", path,
+                                     WS_PAGSZ, WS_INTERVAL, NULL };
+
+                sprintf (path, "%s/%s-%s-%s.trc", dir, algorithms[a],
+                               initial[i], sizes[t]);
+
+                fprintf (stderr, "# %s %s %s\n", algorithms[a],
+                                 initial[i], sizes[t]);
+
+                if (run(gen_argv,runs,&gen)<0 || run(ws_argv,runs,&ws)<0)
+                {
+                    unlink (path);
+                    ok = 0;
+                    break;
+                }
+
+                refs = 0;
+
+                for (p=0; ok && policies[p]; p++)
+                    for (s=0; ok && pagsizes[s]; s++)
+                        for (f=0; ok && numframes[f]; f++)
+                        {
+                            char * sim_argv[] = { SIM_PAG, "-p",
+                                                  (char*)policies[p],
+                                                  "-f", path,
+                                                  (char*)pagsizes[s],
+                                                  (char*)numframes[f],
+                                                  NULL };
+
+                            if (run(sim_argv,runs,&sim)<0)
+                            {
+                                ok = 0;
+                                break;
+                            }
+
+                            refs = report_counter (&sim,
+                                                   "Read references:") +
+                                   report_counter (&sim,
+                                                   "Write references:");
+                            faults = report_counter (&sim,
+                                                     "Page faults:");
+                            writebacks = report_counter (&sim,
+                                                "Page dumps to disc:");
+
+                            print_row (csv, "sim_pag", algorithms[a],
+                                       initial[i], sizes[t], policies[p],
+                                       pagsizes[s], numframes[f], refs,
+                                       faults, writebacks, &sim);
+                        }
+
+                unlink (path);
+
+                if (!ok)
+                    break;
+
+                // The references of the trace are the ones that
+                // sim_pag simulated
+                print_row (csv, "gen_trace", algorithms[a], initial[i],
+                           sizes[t], "", "", "", refs, 0, 0, &gen);
+                print_row (csv, "calculate_ws", algorithms[a],
+                           initial[i], sizes[t], "", WS_PAGSZ, "", refs,
+                           0, 0, &ws);
+                fflush (csv);
+            }
+
+    rmdir (dir);
+
+    if (csv!=stdout && fclose(csv)!=0)
+        ok = 0;
+
+    return ok ? 0 : -1;
+}
+
+// Function that returns the wall time, in seconds
+
+static double now (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec/1e9;
+}
+
+// Function that runs a program runs times
+
+int run (char * const argv[], int runs, srun * R)
+{
+    struct rusage ru;   // Resources used by the child
+    int fds[2];         // Pipe from its standard output
+    char chunk[4096];   // What it writes, piece by piece
+    size_t len;         // Bytes kept in R->report
+    ssize_t n;
+    double t0, t;
+    int status, k;
+    pid_t pid;
+
+    R->seconds = 0;
+    R->maxrss = 0;
+
+    for (k=0; k<runs; k++)
+    {
+        if (pipe(fds)<0)
+        {
+            perror ("ERROR creating a pipe");
+            return -1;
+        }
+
+        t0 = now ();
+        pid = fork ();
+
+        if (pid<0)
+        {
+            perror ("ERROR starting a process");
+            close (fds[0]);
+            close (fds[1]);
+            return -1;
+        }
+
+        if (pid==0)     // Child: its output goes to the pipe
+        {
+            dup2 (fds[1], 1);
+            close (fds[0]);
+            close (fds[1]);
+            execv (argv[0], argv);
+            perror (argv[0]);
+            _exit (127);
+        }
+
+        close (fds[1]);
+
+        // Keep the beginning of the output, and skip the rest
+        for (len=0; (n=read(fds[0],chunk,sizeof(chunk))) > 0; )
+            if (len<sizeof(R->report)-1)
+            {
+                if ((size_t)n>sizeof(R->report)-1-len)
+                    n = sizeof(R->report)-1-len;
+
+                memcpy (R->report+len, chunk, n);
+                len += n;
+            }
+
+        R->report[len] = '\0';
+        close (fds[0]);
+
+        if (wait4(pid,&status,0,&ru)<0 || !WIFEXITED(status) ||
+            WEXITSTATUS(status)!=0)
+        {
+            fprintf (stderr, "ERROR: %s did not end well\n", argv[0]);
+            return -1;
+        }
+
+        t = now () - t0;
+
+        if (k==0 || t<R->seconds)
+            R->seconds = t;
+
+        if (ru.ru_maxrss>R->maxrss)     // KB in Linux
+            R->maxrss = ru.ru_maxrss;
+    }
+
+    return 0;
+}
+
+// Function that takes a counter from the report of sim_pag
+
+unsigned long long report_counter (const srun * R, const char * label)
+{
+    const char * line = strstr (R->report, label);
+    unsigned long long u;
+
+    if (!line || sscanf(line+strlen(label),"%llu",&u)!=1)
+        return 0;
+
+    return u;
+}
+
+// Function that prints one row of the CSV
+
+void print_row (FILE * csv, const char * component, const char * alg,
+                const char * ini, const char * size, const char * policy,
+                const char * pagsz, const char * frames,
+                unsigned long long refs, unsigned long long faults,
+                unsigned long long writebacks, const srun * R)
+{
+    fprintf (csv, "%s,%s,%s,%s,%s,%s,%s,%llu,%llu,%llu,%.6f,%.0f,%ld\n",
+                  component, alg, ini, size, policy, pagsz, frames,
+                  refs, faults, writebacks, R->seconds,
+                  R->seconds>0 ? refs/R->seconds : 0, R->maxrss);
+}
@@ -0,0 +1,68 @@
+#!/bin/sh
+#
+#   bench_pgt.sh
+#
+#   Throughput of the simulator with the two layouts of the page
+#   table (see sim_paging.h): sim_pag_aos (array of spage) and
+#   sim_pag_soa (structure of arrays, -DPGT_SOA), both built with
+#   -O2 by "make bench_pgt". Every configuration is run over the
+#   same stored trace, best of RUNS runs.
+#
+#   Usage: ./bench_pgt.sh [alg initord numelem]   (QUI RAN 20000)
+
+ALG=${1:-QUI}
+INI=${2:-RAN}
+NUM=${3:-20000}
+RUNS=3
+TRACE=/tmp/bench_pgt.$$.trc
+
+# Configurations: policy, page size and frames. Small pages and
+# thousands of frames, so that the page table is bigger than the
+# caches and the searches of LRU(t) go over many entries.
+CONFIGS="LRU:1:256 LRU:1:4096 LRU:16:64 FIFO:1:4096 CLOCK:1:4096
+         WS:1:4096 ARC:1:4096"
+
+./gen_trace -b -o $TRACE $ALG $INI $NUM || exit 1
+trap 'rm -f $TRACE' EXIT
+
+now ()
+{
+    date +%s.%N
+}
+
+best ()    # Best time of RUNS runs of a command
+{
+    i=0
+    b=
+    while [ $i -lt $RUNS ]
+    do
+        s=$(now)
+        "$@" > /dev/null || return 1
+        e=$(now)
+        b=$(awk -v s=$s -v e=$e -v b="$b" \
+                'BEGIN { t = e-s; print (b=="" || t<b) ? t : b }')
+        i=$((i+1))
+    done
+    echo $b
+}
+
+# References of the trace (reads and writes)
+REFS=$(./sim_pag -f $TRACE 16 16 | awk '/^(Read|Write) references/ { n += $3 }
+                                        END { print n }')
+
+echo "# Trace: $ALG $INI $NUM ($REFS references), best of $RUNS runs"
+printf "%-14s %12s %12s %8s\n" "CONFIG" "AOS Mref/s" "SOA Mref/s" "SPEEDUP"
+
+for c in $CONFIGS
+do
+    p=$(echo $c | cut -d: -f1)
+    sz=$(echo $c | cut -d: -f2)
+    nf=$(echo $c | cut -d: -f3)
+
+    ta=$(best ./sim_pag_aos -p $p -f $TRACE $sz $nf) || exit 1
+    ts=$(best ./sim_pag_soa -p $p -f $TRACE $sz $nf) || exit 1
+
+    awk -v c=$c -v r=$REFS -v a=$ta -v s=$ts \
+        'BEGIN { printf "%-14s %12.2f %12.2f %7.2fx\n",
+                        c, r/a/1e6, r/s/1e6, a/s }'
+done
@@ -5,6 +5,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "trace.h"
+#include "sort.h"
+
+// Largest number of sliding windows computed at once
+
+#define MAX_TAUS 16
 
 // Structure holding data of the parameters passed through
 // the command line (algorithm to be used etc.)
@@ -14,6 +23,11 @@ typedef struct
     int pagesz, interval;
     const char * algorithm, * initialorder;
     int numelem;
+    char binary;        // 1 = ask gen_trace for a binary trace
+    const char * tracefile;  // Stored trace to replay (or NULL)
+    char inprocess;     // 1 = sort here instead of with gen_trace
+    int numtaus;        // >0 = sliding windows instead of intervals
+    unsigned taus[MAX_TAUS];  // Sizes of the windows
 }
 sparameters;
 
@@ -22,23 +36,65 @@ sparameters;
 
 int parse_command (int, char*[], sparameters*);
 
-// Structure that maintains the set of referenced pages:
+// Structure that maintains the working sets of Denning W(t,tau),
+// the pages referenced in the last tau references, for several
+// sizes tau at once. Every page keeps the time of its last
+// reference, so a reference adds its page to the windows where
+// it wasn't, and the reference that falls out of each window (the
+// one tau references ago, taken from a ring of the last ones)
+// takes its page out if it wasn't referenced again since then.
+// That is O(1) per reference and window.
+
+typedef struct
+{
+    int numtaus;              // # of windows
+    unsigned taus[MAX_TAUS];  // Their sizes (tau)
+    unsigned counts[MAX_TAUS];     // Pages in each one now
+    unsigned maxcounts[MAX_TAUS];  // Largest sample
+    unsigned long long sums[MAX_TAUS];  // Sum of the samples
+    unsigned long long numsamples;  // # of samples
+    unsigned maxtau;          // Size of the ring
+    unsigned long long * plast;  // Time of the last reference of
+                                 // each page (0 = never)
+    unsigned * pring;         // Pages of the last maxtau refs.
+    unsigned long long now;   // # of references so far
+}
+swindows;
+
+// Structure that maintains the set of referenced pages: one
+// bit per page, in 64-bit words. The pages of the interval are
+// counted as they are set, and only the words that got some bit
+// set are cleared afterwards (the ones in the dirty list), so an
+// interval costs as much as its references and not as the array.
 
-#define NUM_BYTES(BITS) ((BITS+7)>>3)
-#define SET_BIT(P,NBIT) ((P)[(NBIT)>>3] |= 1<<((NBIT)&7))
-#define GET_BIT(P,NBIT) ((P)[(NBIT)>>3] & (1<<((NBIT)&7)))
+#define NUM_WORDS(BITS) (((BITS)+63)>>6)
+#define WORD_BIT(NBIT) ((uint64_t)1<<((NBIT)&63))
 
 typedef struct
 {
-    char * prefbits;      // Reference bits of the pages
-    int numbytes;         // Size in bytes
+    uint64_t * pwords;    // Reference bits of the pages
+    unsigned * pdirty;    // Words with some bit set
+    unsigned numdirty;    // How many
+    int numwords;         // Size in words
     unsigned numpages;    // # of pages (and ref. bits)
+    unsigned numdistinct; // # of pages referenced in the interval
     unsigned numrefs;     // # of references in current interval
-    unsigned totalrefs;   // Total # of references
-    unsigned numillegal;  // # of illegal references
+    unsigned long long totalrefs;   // Total # of references
+    unsigned long long numillegal;  // # of illegal references
+    swindows * pW;        // Sliding windows (NULL = intervals)
 }
 spgstate;
 
+// Functions that manipulate the sliding windows
+
+int reserve_windows (const sparameters *, swindows *, int numpages);
+void free_windows (swindows *);
+
+void annotate_window (const sparameters *, swindows *, unsigned page);
+
+void print_window_header (const swindows *);
+void print_window_summary (const swindows *);
+
 // Functions that manipulate the referenced pages set
 
 int reserve_bits (spgstate *, int numpages);
@@ -51,21 +107,39 @@ void annotate_reference (const sparameters *,
 void dump_num_refs (spgstate *);
 void print_header (void);
 
+// Function that receives the operations of a sort run inside
+// the process (-i), and what it needs to annotate them
+
+typedef struct
+{
+    const sparameters * pPar;
+    spgstate * pS;
+}
+sannotate;
+
+void annotate_operation (void *, char op, unsigned pos);
+
 // Main function
 
 int main (int argc, char * argv[])
 {
     sparameters P;      // Parameters received in the command line
     char command[100];  // Command for executing gen_trace
-    FILE * pipe;        // Communication channel with gen_traza
+    strace T;           // Trace coming from gen_trace
+    sref refs[TRACE_BLOCK];  // Block of operations of the trace
     int ok;             // Flag
-    char op;            // Elementary operation ('R'ead, 'W'ri..)
-    unsigned u;         // Number of the read/written element
+    int n, i;           // Operations in the block and index
     spgstate S;         // State of the pages (referenced/not)
     unsigned numpags;   // Total number of pages
-    unsigned totelem;   // Total num. of elements (double in MER)
+    unsigned totalsz;   // Total # of elements (double in MER)
+    sannotate A;        // Where the operations go (-i)
+    swindows W;         // Sliding windows (-w)
 
-    S.prefbits = NULL;
+    S.pwords = NULL;
+    S.pdirty = NULL;
+    S.pW = NULL;
+    W.plast = NULL;
+    W.pring = NULL;
 
     if (parse_command(argc,argv,&P)<0)  // Put parameters in P
         return -1;
@@ -74,80 +148,106 @@ int main (int argc, char * argv[])
             argv[0], P.pagesz, P.interval,
             P.algorithm, P.initialorder, P.numelem);
 
-    // Prepare command for invoking gen_trace
-    // (sprintf "prints" in a string)
-    sprintf (command, "./gen_trace %s %s %u",
-                      P.algorithm, P.initialorder, P.numelem);
+    if (P.inprocess)
+    {
+        printf ("# Sorting in process:  %s %s %u\n",
+                P.algorithm, P.initialorder, P.numelem);
 
-    printf ("# Executing command:  %s\n", command);
+        totalsz = sort_total_size (find_sort(P.algorithm), P.numelem);
+        ok = 1;
+    }
+    else
+    {
+        if (P.tracefile)
+        {
+            printf ("# Reading trace file:  %s\n", P.tracefile);
 
-    // Invoke gen_trace and open a pipe to read
-    // its standard output ("r" stands for read)
-    pipe = popen (command, "r");
+            // Map the stored trace and read total # of elements
+            ok = trace_map (&T, P.tracefile) == 0;
+        }
+        else
+        {
+            // Prepare command for invoking gen_trace
+            // (sprintf "prints" in a string)
+            sprintf (command, "./gen_trace %s%s %s %u",
+                              P.binary ? "-b " : "",
+                              P.algorithm, P.initialorder, P.numelem);
 
-    if (!pipe)
-    {
-        perror ("ERROR while starting gen_trace");
-        return -1;
-    }
+            printf ("# Executing command:  %s\n", command);
+
+            // Invoke gen_trace and read total # of elements
+            // to be sorted
+            ok = trace_open (&T, command) == 0;
+        }
 
-    // Read total # of elements to be sorted
-    ok = fscanf (pipe," T %u", &totelem) == 1;
+        totalsz = T.totalsz;
+    }
 
     if (ok)
     {
         // Calculate total number of pages
-        numpags = (totelem+P.pagesz-1) / P.pagesz; 
+        numpags = (totalsz+P.pagesz-1) / P.pagesz; 
 
         // Reserve space for the reference bits
-        if (reserve_bits(&S,numpags)<0)
+        if (reserve_bits(&S,numpags)<0 ||
+            (P.numtaus && reserve_windows(&P,&W,numpags)<0))
         {
             fprintf (stderr,
                      "ERROR: not enough "
                             "dynamic memory\n");
             ok = 0;
         }
+
+        if (P.numtaus)
+            S.pW = &W;
     }
 
-    if (ok)
+    if (ok && S.pW)
+        print_window_header (&W);
+    else if (ok)
         print_header ();
 
-    while (ok)
+    if (ok && P.inprocess)
+    {
+        A.pPar = &P;
+        A.pS = &S;
+
+        ok = sort_in_process (find_sort(P.algorithm),
+                              find_prepare(P.initialorder),
+                              P.numelem, annotate_operation, &A) == 0;
+    }
+
+    while (ok && !P.inprocess && (n=trace_read(&T,refs,TRACE_BLOCK)) != 0)
     {
-        // Ignore spaces and read one character
-        if (fscanf(pipe," %c",&op)!=1)
+        if (n<0)
         {
             ok = 0;
             break;
         }
 
-        if (op=='R' || op=='W')              // If R/W,
-        {                                    // take element
-            if (fscanf(pipe,"%u",&u)!=1)     // number and
-                ok = 0;                      // annotate
-            else
-                annotate_reference (&P, &S, u);
-        }
-        else if (op=='S')        // 'S'orted -> end
-            break;               // 'C'omparison -> go on
-        else if (op!='C')        // 'O'ut of order (or
-            ok = 0;              // something else) -> error
+        for (i=0; i<n; i++)
+            if (refs[i].op!='C')                       // If R/W,
+                annotate_reference (&P, &S, refs[i].elem);  // annotate
     }
 
     if (ok)
     {
-        dump_num_refs (&S);
+        if (S.pW)
+            print_window_summary (&W);
+        else
+            dump_num_refs (&S);
 
         if (S.numillegal)
-            printf ("WARNING: There were %u references to "
+            printf ("WARNING: There were %llu references to "
                              "nonexistent pages\n", S.numillegal);
     }
 
     // Wait until gen_trace ends and close
-    if (pclose(pipe)==-1)
+    if (!P.inprocess && trace_close(&T)<0)
         ok = 0;
 
     free_bits (&S);
+    free_windows (&W);
 
     return ok ? 0 : -1;
 }
@@ -157,23 +257,25 @@ int main (int argc, char * argv[])
 int reserve_bits (spgstate * pS, int numpages)
 {
     pS->numpages = numpages;
-    pS->numbytes = NUM_BYTES (numpages);
+    pS->numwords = NUM_WORDS (numpages);
+    pS->numdirty = pS->numdistinct = 0;
     pS->numrefs = pS->totalrefs = pS->numillegal = 0;
-    pS->prefbits = (char*) malloc (pS->numbytes);
+    pS->pwords = (uint64_t*) calloc (pS->numwords, sizeof(uint64_t));
+    pS->pdirty = (unsigned*) malloc (pS->numwords*sizeof(unsigned));
 
-    if (pS->prefbits)
-    {
-        memset (pS->prefbits, 0, pS->numbytes);
+    if (pS->pwords && pS->pdirty)
         return 0;
-    }
 
+    free_bits (pS);
     return -1;
 }
 
 void free_bits (spgstate * pS)
 {
-    free (pS->prefbits);
-    pS->prefbits = NULL;
+    free (pS->pwords);
+    free (pS->pdirty);
+    pS->pwords = NULL;
+    pS->pdirty = NULL;
 }
 
 void annotate_reference (const sparameters * pPar,
@@ -181,12 +283,24 @@ void annotate_reference (const sparameters * pPar,
                          unsigned element)
 {
     unsigned page;
+    uint64_t * pw;
 
     page = element / pPar->pagesz;
 
-    if (page < pS->numpages)
+    if (page < pS->numpages && pS->pW)
+        annotate_window (pPar, pS->pW, page);
+    else if (page < pS->numpages)
     {
-        SET_BIT (pS->prefbits, page);
+        pw = &pS->pwords[page>>6];
+
+        if (!(*pw & WORD_BIT(page)))    // First time in the
+        {                               // interval
+            if (!*pw)
+                pS->pdirty[pS->numdirty++] = page>>6;
+
+            *pw |= WORD_BIT (page);
+            pS->numdistinct ++;
+        }
 
         if (++pS->numrefs >= pPar->interval)
             dump_num_refs (pS);
@@ -195,6 +309,14 @@ void annotate_reference (const sparameters * pPar,
         pS->numillegal ++;
 }
 
+void annotate_operation (void * arg, char op, unsigned pos)
+{
+    sannotate * pA = (sannotate*) arg;
+
+    if (op!='C')                                 // If R/W,
+        annotate_reference (pA->pPar, pA->pS, pos);  // annotate
+}
+
 void print_header (void)
 {
     printf ("#\n#%18s %15s %15s %15s\n#\n",
@@ -203,24 +325,145 @@ void print_header (void)
 
 void dump_num_refs (spgstate * pS)
 {
-    unsigned u, refs;
+    unsigned u;
 
     if (!pS->numrefs)
         return;
 
-    for (u=refs=0; u<pS->numpages; u++)
-        if (GET_BIT(pS->prefbits, u))
-            refs ++;
-
-    printf (" %15u %15u %15u %15f\n",
+    printf (" %15llu %15u %15u %15f\n",
             pS->totalrefs, pS->numrefs,
-            refs, refs/(float)pS->numrefs);
+            pS->numdistinct, pS->numdistinct/(float)pS->numrefs);
 
-    memset (pS->prefbits, 0, pS->numbytes);
+    for (u=0; u<pS->numdirty; u++)
+        pS->pwords[pS->pdirty[u]] = 0;
+
+    pS->numdirty = pS->numdistinct = 0;
     pS->totalrefs += pS->numrefs;
     pS->numrefs = 0;
 }
 
+// Functions that manipulate the sliding windows
+
+int reserve_windows (const sparameters * pPar, swindows * pW,
+                     int numpages)
+{
+    int j;
+
+    memset (pW, 0, sizeof(*pW));
+
+    pW->numtaus = pPar->numtaus;
+
+    for (j=0; j<pW->numtaus; j++)
+    {
+        pW->taus[j] = pPar->taus[j];
+
+        if (pW->taus[j] > pW->maxtau)
+            pW->maxtau = pW->taus[j];
+    }
+
+    pW->plast = (unsigned long long*) calloc (numpages,
+                                              sizeof(unsigned long long));
+    pW->pring = (unsigned*) malloc (pW->maxtau*sizeof(unsigned));
+
+    if (pW->plast && pW->pring)
+        return 0;
+
+    free_windows (pW);
+    return -1;
+}
+
+void free_windows (swindows * pW)
+{
+    free (pW->plast);
+    free (pW->pring);
+    pW->plast = NULL;
+    pW->pring = NULL;
+}
+
+void annotate_window (const sparameters * pPar, swindows * pW,
+                      unsigned page)
+{
+    unsigned long long t, last;
+    unsigned old;
+    int j;
+
+    t = ++pW->now;
+    last = pW->plast[page];
+
+    for (j=0; j<pW->numtaus; j++)
+    {
+        // The reference t-tau falls out of the window
+        if (t > pW->taus[j])
+        {
+            old = pW->pring[(t-pW->taus[j]) % pW->maxtau];
+
+            if (pW->plast[old] == t-pW->taus[j])
+                pW->counts[j] --;
+        }
+
+        // And this page comes in, if it wasn't there
+        if (last==0 || t-last >= pW->taus[j])
+            pW->counts[j] ++;
+    }
+
+    pW->plast[page] = t;
+    pW->pring[t % pW->maxtau] = page;
+
+    if (t % pPar->interval == 0)    // Take a sample
+    {
+        printf (" %15llu", t);
+
+        for (j=0; j<pW->numtaus; j++)
+        {
+            printf (" %12u", pW->counts[j]);
+
+            pW->sums[j] += pW->counts[j];
+
+            if (pW->counts[j] > pW->maxcounts[j])
+                pW->maxcounts[j] = pW->counts[j];
+        }
+
+        printf ("\n");
+        pW->numsamples ++;
+    }
+}
+
+void print_window_header (const swindows * pW)
+{
+    char title[32];
+    int j;
+
+    printf ("#\n#%14s", "Position");
+
+    for (j=0; j<pW->numtaus; j++)
+    {
+        sprintf (title, "W(t,%u)", pW->taus[j]);
+        printf (" %12s", title);
+    }
+
+    printf ("\n#\n");
+}
+
+void print_window_summary (const swindows * pW)
+{
+    int j;
+
+    if (!pW->numsamples)
+        return;
+
+    printf ("#\n#%14s", "Mean");
+
+    for (j=0; j<pW->numtaus; j++)
+        printf (" %12.2f", pW->sums[j]/(double)pW->numsamples);
+
+    printf ("\n#%14s", "Max");
+
+    for (j=0; j<pW->numtaus; j++)
+        printf (" %12u", pW->maxcounts[j]);
+
+    printf ("\n");
+}
+
 // Function that parses the parameters received through the
 // command line:
 
@@ -229,7 +472,9 @@ void dump_num_refs (spgstate * pS)
 
 int parse_command (int argc, char * argv[], sparameters * p)
 {
-    int ok;
+    const char * prog = argv[0];
+    int ok, opt;
+    char * tau;
 
     // Default parameters
     p->pagesz = 16;
@@ -237,13 +482,56 @@ int parse_command (int argc, char * argv[], sparameters * p)
     p->algorithm = "MER";
     p->initialorder = "RAN";
     p->numelem = 1000;
+    p->binary = 0;
+    p->tracefile = NULL;
+    p->inprocess = 0;
+    p->numtaus = 0;
+
+    // Options go before the positional parameters
+
+    ok = 1;
+
+    while ((opt=getopt(argc,argv,"bf:iw:")) != -1)
+        switch (opt)
+        {
+            case 'b':
+                p->binary = 1;
+                break;
+
+            case 'f':
+                p->tracefile = optarg;
+                break;
+
+            case 'i':
+                p->inprocess = 1;
+                break;
+
+            case 'w':
+                for (tau=strtok(optarg,","); tau; tau=strtok(NULL,","))
+                    if (p->numtaus==MAX_TAUS ||
+                        sscanf(tau,"%u",&p->taus[p->numtaus])!=1 ||
+                        p->taus[p->numtaus]<1)
+                    {
+                        fprintf (stderr,
+                                 "\n    ERROR: wrong window size\n");
+                        ok = 0;
+                        break;
+                    }
+                    else
+                        p->numtaus ++;
+                break;
+
+            default:
+                ok = 0;
+        }
+
+    argc -= optind-1;
+    argv += optind-1;
 
     if (argc>6)
         ok = 0;
     else
     {
-        ok = 1;
-
         if (argc>1 && (sscanf(argv[1],"%d",&p->pagesz)!=1 ||
                        p->pagesz<1))
         {
@@ -253,7 +541,7 @@ int parse_command (int argc, char * argv[], sparameters * p)
         }
 
         if (argc>2 && (sscanf(argv[2],"%d",&p->interval)!=1 ||
-                       p->interval<2))
+                       p->interval<(p->numtaus ? 1 : 2)))
         {
             fprintf (stderr,
                      "\n    ERROR: wrong interval\n");
@@ -294,12 +582,19 @@ int parse_command (int argc, char * argv[], sparameters * p)
         }
     }
 
+    if (p->inprocess && p->tracefile)
+    {
+        fprintf (stderr,
+                 "\n    ERROR: -i and -f are incompatible\n");
+        ok = 0;
+    }
+
     if (ok)
         return 0;
 
     fprintf (stderr,
-             "\n    USAGE:\n\t%s pagesz interval algorithm "
-                        "initialorder numelem\n\n", argv[0]);
+             "\n    USAGE:\n\t%s [options] pagesz interval algorithm "
+                        "initialorder numelem\n\n", prog);
 
     fprintf (stderr,
              "\tpagesz: nº de elementos que caben "
@@ -308,14 +603,25 @@ int parse_command (int argc, char * argv[], sparameters * p)
              "\talgorithm: sorting algorithm (%s)\n"
              "\tinitialorder: initial order of the array (%s)\n"
              "\tnumelem: # of elements to be sorted\n"
+             "\n"
+             "    OPTIONS:\n"
+             "\t-b: read the trace in compact binary format\n"
+             "\t-f file: replay a trace stored by gen_trace -o\n"
+             "\t         (algorithm, initialorder and numelem are ignored)\n"
+             "\t-i: run the sort inside the program, without\n"
+             "\t    gen_trace nor any trace in between\n"
+             "\t-w tau,...: sliding working sets W(t,tau) instead\n"
+             "\t            of intervals, for each tau, sampled every\n"
+             "\t            interval operations (it can be 1)\n"
              "\n",
              VALID_ALGORITHMS, VALID_INITIAL_ORD);
 
     fprintf (stderr,
              "    EXAMPLE:\n"
              "\t%s 16 2000 MER RAN 1000\n"
+             "\t%s -w 100,1000,10000 16 500 MER RAN 5000\n"
              "\n",
-             argv[0]);
+             prog, prog);
 
     return -1;
 }
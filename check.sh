@@ -0,0 +1,108 @@
+#!/bin/sh
+#
+#   check.sh
+#
+#   Checks run by "make check": the options that the README says
+#   give the same results must give them. Every check compares the
+#   page faults and write backs (or the tables of count_ops) that
+#   two ways of simulating the same trace give, and the script
+#   stops at the first difference. Besides, the cases of -i -m that
+#   once hung: the references an exact multiple of MULTI_BLOCK (BUB
+#   ASC 65536), and one more.
+#
+#   Usage: ./check.sh
+
+WORK="QUI RAN 3000"
+TRACE=/tmp/check.$$.trc
+SHARDS=/tmp/check.$$.res
+
+trap 'rm -f $TRACE $SHARDS.1 $SHARDS.2' EXIT
+
+fail ()
+{
+    echo "FAILED: $*"
+    exit 1
+}
+
+same ()    # same description expected got
+{
+    [ -n "$2" ] || fail "$1: no results"
+    [ "$2" = "$3" ] || fail "$1: $3 instead of $2"
+    echo "ok   $1"
+}
+
+counts ()  # Faults and write backs of the report of one system
+{
+    "$@" | awk '/^Page faults:/        { f = $3 }
+                /^Page dumps to disc:/ { w = $5 }
+                END                    { print f, w }'
+}
+
+rows ()    # Policy, page size, frames, faults and write backs of -m
+{
+    "$@" | awk '!/^#/ && NF > 7 { print $1, $2, $3, $6, $7 }'
+}
+
+./gen_trace -o $TRACE $WORK > /dev/null || fail "gen_trace -o"
+
+# One trace, four ways of reading it, and LRU with its two searches
+BASE=$(counts ./sim_pag 16 8 $WORK)
+
+same "-b" "$BASE" "$(counts ./sim_pag -b 16 8 $WORK)"
+same "-f" "$BASE" "$(counts ./sim_pag -f $TRACE 16 8)"
+same "-i" "$BASE" "$(counts ./sim_pag -i 16 8 $WORK)"
+same "-x" "$BASE" "$(counts ./sim_pag -x 16 8 $WORK)"
+
+# Runs of references to the same page, for the policies that do
+# something with them (reference_run), and two that don't
+for p in LRU WS PFF ARC 2Q FIFO
+do
+    same "-R -p $p" "$(counts ./sim_pag -p $p -f $TRACE 16 8)" \
+                    "$(counts ./sim_pag -R -p $p -f $TRACE 16 8)"
+done
+
+# The LRU fault curve, one run per number of frames
+./sim_pag -c 8 -f $TRACE 16 8 |
+    awk '/^LRU fault curve/ { on = 1; getline; next }
+         on && NF == 3      { print $1, $2, $3 }' |
+while read f faults writebacks
+do
+    same "-c, $f frames" "$(counts ./sim_pag -f $TRACE 16 $f)" \
+                         "$faults $writebacks"
+done || exit 1
+
+# Every row of -m, with rounds or not, is the report of its system
+CONFIGS=LRU:8,FIFO:8,FIFO2CH:8,CLOCK:8:32,ECLOCK:8,RANDOM:8,WS:16,PFF:16,ARC:8,2Q:8,OPT:8
+
+rows ./sim_pag -m $CONFIGS -f $TRACE 16 8 |
+while read p sz nf faults writebacks
+do
+    same "-m $p:$nf:$sz" "$(counts ./sim_pag -p $p -f $TRACE $sz $nf)" \
+                         "$faults $writebacks"
+done || exit 1
+
+M=$(rows ./sim_pag -m $CONFIGS -f $TRACE 16 8)
+
+same "-m -k 3 -j 2" "$M" "$(rows ./sim_pag -k 3 -j 2 -m $CONFIGS -f $TRACE 16 8)"
+same "-m -i" "$M" "$(rows ./sim_pag -i -m $CONFIGS 16 8 $WORK)"
+
+# The -i -m blocks of MULTI_BLOCK references
+for n in 65536 65537
+do
+    timeout 60 ./sim_pag -i -m LRU:8,FIFO:8 16 8 BUB ASC $n > /dev/null ||
+        fail "-i -m BUB ASC $n"
+    echo "ok   -i -m BUB ASC $n"
+done
+
+timeout 60 ./sim_pag -i -k 1 -m LRU:8,FIFO:8 16 8 BUB ASC 65536 > /dev/null ||
+    fail "-i -k 1 -m BUB ASC 65536"
+echo "ok   -i -k 1 -m BUB ASC 65536"
+
+# count_ops: two shards merged, and the whole matrix at once
+MATRIX="-a BUB,SEL,HEA -i ASC,RAN -s 10,50"
+
+./count_ops $MATRIX -S 1/2 -o $SHARDS.1 > /dev/null || fail "count_ops -S 1/2"
+./count_ops $MATRIX -S 2/2 -o $SHARDS.2 > /dev/null || fail "count_ops -S 2/2"
+
+same "count_ops -S -M" "$(./count_ops $MATRIX | grep -v '^Executing')" \
+     "$(./count_ops -M $SHARDS.2 $SHARDS.1)"
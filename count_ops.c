@@ -4,132 +4,680 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
 
-#define NUM_ALG 8
-#define NUM_INI 3
-#define NUM_SZS 3
+#include "trace.h"
 
-int main ()
+#define MAX_ALG 8
+#define MAX_INI 3
+#define MAX_SZS 32
+
+#define SHARD_MAGIC "count_ops results 1"   // First line of a shard
+
+// Initial states of the array: ASCending order,
+// DEScending order and RANdom order (or rather disorder)
+static const char * all_initial[MAX_INI] = { "ASC", "DES", "RAN" };
+
+// Sorting algorithms: bubble, insertion, selection,
+// heapsort, combsort, mergesort, quicksort, and
+// quicksort with random pivot
+static const char * all_algorithms[MAX_ALG] = { "BUB", "INS", "SEL",
+                                                "HEA", "COM", "MER",
+                                                "QUI", "QRP" };
+
+// Structure holding the matrix of experiments (one cell for
+// each algorithm, initial state and size) and the results.
+// The workers take the cells in order, one at a time. With
+// shards (-S), cell c belongs to shard c % numshards, so every
+// shard gets some of the small sizes and some of the big ones.
+
+typedef struct
 {
-    // Initial states of the array: ASCending order,
-    // DEScending order and RANdom order (or rather disorder)
-    const char * initial[NUM_INI] = { "ASC", "DES", "RAN" };
-
-    // Array sizes with wich to experiment
-    unsigned sizes[NUM_SZS] = { 10, 100, 1000 };
-
-    // Sorting algorithms: bubble, insertion, selection,
-    // heapsort, combsort, mergesort, quicksort, and
-    // quicksort with random pivot
-    const char * algorithms[NUM_ALG] = { "BUB", "INS", "SEL",
-                                         "HEA", "COM", "MER",
-                                         "QUI", "QRP" };
-
-    char command[100]; // Command for executing gen_trace
-    FILE * pipe;       // Channel for communicating with gen_trace
-    int a, i, t, ok;   // Array indexes and flag
-    char op;           // Elementary operation ('R'ead, 'W'rite...)
-    unsigned u;        // Number of read/written element
-    unsigned sz;       // Size of the array to sort
+    const char * algorithms[MAX_ALG];
+    const char * initial[MAX_INI];
+    unsigned sizes[MAX_SZS];
+    int numalg, numini, numszs;
+
+    const char * dir;  // Directory of stored traces (or NULL)
+    char binary;       // 1 = ask gen_trace for binary traces
+
+    int shard, numshards;   // Cells run here (shard from 0)
+
+    pthread_mutex_t lock;   // Protects next
+    int next;               // Next cell of the shard to be run
+
+    unsigned long long results[MAX_ALG][MAX_INI][MAX_SZS];
+}
+sexperiments;
+
+// Functions that parse the lists of the command line
+
+int parse_names (char * list, const char * valid[], int numvalid,
+                 const char * names[]);
+int parse_sizes (char * list, unsigned sizes[]);
+
+// Functions that keep the results of a shard in a file, and put
+// the ones of every shard together (-1 on error)
+
+int write_shard (sexperiments * E, const char * path);
+int merge_shards (sexperiments * E, int numfiles, char * files[]);
+
+// Function that prints the tables of results
+
+void print_tables (sexperiments * E);
+
+// Function that reports the cells of the shard that failed (0
+// operations), returning how many
+
+int failed_cells (sexperiments * E);
+
+// Function that counts the operations of one experiment
+// (0 if an error occurred)
+
+unsigned long long count_cell (sexperiments * E, int a, int i, int t);
+
+// Function run by every worker
+
+void * worker (void * arg);
+
+int main (int argc, char * argv[])
+{
+    sexperiments E;    // Experiments and results
+    pthread_t * th;    // Workers
+    int numworkers;    // Number of them
+    int numcells;      // Cells of the shard
+    int failed;        // Cells of the shard without results
+    int i;             // Array index
+    int opt;           // Command line option
+    const char * out;  // Results file of the shard (or NULL)
+    char merge;        // 1 = merge the results files of the shards
+    char matrix;       // 1 = some option chooses the experiments
+
+    // Options:
+    //     -b       read the traces in compact binary format
+    //     -d dir   keep the traces in files in dir, generating
+    //              only the ones that aren't stored there yet
+    //     -a list  algorithms (BUB,INS,...; by default, all)
+    //     -i list  initial states (ASC,DES,RAN; by default, all)
+    //     -s list  array sizes (by default, 10,100,1000)
+    //     -j n     experiments run at once (by default, one
+    //              per processor)
+    //     -S i/n   run only shard i (1..n) of the matrix
+    //     -o file  write the results in file instead of
+    //              printing the tables
+    //     -M       merge the results files given after the
+    //              options and print the tables
+
+    memset (&E, 0, sizeof(E));
 
-    unsigned reads, writes, comparisons;            // Counters
-    unsigned results[NUM_ALG][NUM_INI][NUM_SZS];    // Tables
+    E.numalg = MAX_ALG;
+    memcpy (E.algorithms, all_algorithms, sizeof(all_algorithms));
+    E.numini = MAX_INI;
+    memcpy (E.initial, all_initial, sizeof(all_initial));
+    E.numszs = 3;
+    E.sizes[0] = 10;
+    E.sizes[1] = 100;
+    E.sizes[2] = 1000;
+
+    E.numshards = 1;
+
+    numworkers = sysconf (_SC_NPROCESSORS_ONLN);
+    out = NULL;
+    merge = matrix = 0;
+
+    while ((opt=getopt(argc,argv,"a:bd:i:j:Mo:s:S:")) != -1)
+    {
+        matrix |= opt!='j' && opt!='M';
+
+        if (opt=='M')
+            merge = 1;
+        else if (opt=='o')
+            out = optarg;
+        else if (opt=='S' &&
+                 sscanf(optarg,"%d/%d",&E.shard,&E.numshards)==2 &&
+                 E.numshards>0 && E.shard>0 && E.shard<=E.numshards)
+            E.shard --;
+        else if (opt=='b')
+            E.binary = 1;
+        else if (opt=='d' && strlen(optarg)<150)
+            E.dir = optarg;
+        else if (opt=='a' &&
+                 (E.numalg=parse_names(optarg,all_algorithms,MAX_ALG,
+                                       E.algorithms)) > 0)
+            ;
+        else if (opt=='i' &&
+                 (E.numini=parse_names(optarg,all_initial,MAX_INI,
+                                       E.initial)) > 0)
+            ;
+        else if (opt=='s' && (E.numszs=parse_sizes(optarg,E.sizes)) > 0)
+            ;
+        else if (opt=='j' && sscanf(optarg,"%d",&numworkers)==1 &&
+                 numworkers>0)
+            ;
+        else
+            break;
+    }
+
+    // Merging takes the experiments from the files, and a shard
+    // is only a part of the tables, so it goes to a file
+    if (opt!=-1 || (merge && (matrix || optind==argc)) ||
+        (!merge && optind<argc) || (E.numshards>1 && !out))
+    {
+        fprintf (stderr, "USAGE: %s [-b] [-d dir] [-a BUB,INS,...] "
+                         "[-i ASC,DES,RAN] [-s 10,100,...] [-j n] "
+                         "[-S i/n -o file]\n"
+                         "       %s -M file...\n",
+                         argv[0], argv[0]);
+        return -1;
+    }
+
+    if (merge)
+    {
+        if (merge_shards(&E,argc-optind,argv+optind)<0)
+            return -1;
+
+        print_tables (&E);
+        return 0;
+    }
+
+    numcells = E.numalg*E.numini*E.numszs;
+    numcells = (numcells - E.shard + E.numshards-1) / E.numshards;
+
+    if (numworkers>numcells)
+        numworkers = numcells;
+
+    if (numworkers<1)
+        numworkers = 1;
 
     // Carry out experiments and fill results tables
 
-    for (t=0; t<NUM_SZS; t++)
-        for (a=0; a<NUM_ALG; a++)
-            for (i=0; i<NUM_INI; i++)
-            {
-                sz = sizes[t];
-                reads = writes = comparisons = 0;
+    pthread_mutex_init (&E.lock, NULL);
 
-                // Make command to invoke gen_trace
-                // (sprintf "prints" in a string)
-                sprintf (command, "./gen_trace %s %s %u",
-                                  algorithms[a], initial[i], sz);
+    th = (pthread_t*) malloc (numworkers*sizeof(pthread_t));
 
-                printf ("Executing command: %s\n", command);
+    if (!th)
+    {
+        fprintf (stderr, "ERROR: not enough dynamic memory\n");
+        return -1;
+    }
 
-                // Invoke gen_trace and open pipe for reading
-                // its standard output ("r" stands for read)
-                pipe = popen (command, "r");
+    for (i=0; i<numworkers; i++)
+        if (pthread_create(&th[i],NULL,worker,&E))
+            break;
 
-                if (!pipe)
-                {
-                    perror ("ERROR starting gen_trace");
-                    return -1;
-                }
+    if (i==0)           // Nobody to help: do it here
+        worker (&E);
 
-                // Read (and ignore) size
-                ok = fscanf (pipe," T %u", &u) == 1;
+    while (i>0)
+        pthread_join (th[--i], NULL);
 
-                while (ok)
-                {
-                    // Ignore spaces and read one character
-                    if (fscanf(pipe," %c",&op)!=1)
-                    {
-                        ok = 0;
-                        break;
-                    }
-
-                    if (op=='R' || op=='W')  // If it's a read
-                    {                        // or a write,
-                        if (op=='R')         // count it and read
-                            reads ++;        // the number of the
-                        else                 // referenced
-                            writes ++;       // element (u)
-
-                        if (fscanf(pipe,"%u",&u)!=1)
-                            ok = 0;
-                    }
-                    else if (op=='C')        // 'C'omparison
-                        comparisons ++;
-                    else if (op=='S')        // 'S'orted (end)
-                        break;
-                    else                     // 'O'ut of order (or
-                        ok = 0;              // sth. else) -> error
-                }
+    free (th);
+    pthread_mutex_destroy (&E.lock);
 
-                // Wait until gen_trace ends and close
-                if (pclose(pipe)==-1)
-                    ok = 0;
+    // A failed cell is no result: no results file with it (a merge
+    // would take it for one), and an error after the tables
+    failed = failed_cells (&E);
+
+    if (out)
+        return failed || write_shard (&E, out) < 0 ? -1 : 0;
+
+    print_tables (&E);
+
+    return failed ? -1 : 0;
+}
 
-                // Store number of operations in the table
-                // (0 if an error occurred)
-                results[a][i][t] = ok ? reads +
-                                        writes +
-                                        comparisons : 0;
-            }
+int failed_cells (sexperiments * E)
+{
+    int cell, a, i, t, n;
+
+    for (n=0, cell=E->shard; cell<E->numalg*E->numini*E->numszs;
+         cell+=E->numshards)
+    {
+        t = cell / (E->numalg*E->numini);
+        a = cell / E->numini % E->numalg;
+        i = cell % E->numini;
+
+        if (!E->results[a][i][t])
+        {
+            fprintf (stderr, "ERROR: no results for %s %s %u\n",
+                     E->algorithms[a], E->initial[i], E->sizes[t]);
+            n ++;
+        }
+    }
 
-    // Print tables
+    return n;
+}
+
+// Function that prints the tables of results
+
+void print_tables (sexperiments * E)
+{
+    int a, i, t;       // Array indexes
 
-    for (i=0; i<NUM_INI; i++)
+    for (i=0; i<E->numini; i++)
     {
-        printf ("\n\nInitial state: %s\n", initial[i]);
+        printf ("\n\nInitial state: %s\n", E->initial[i]);
         printf ("===================\nSize");
 
-        for (a=0; a<NUM_ALG; a++)
-            printf ("%8s", algorithms[a]);
+        for (a=0; a<E->numalg; a++)
+            printf ("%8s", E->algorithms[a]);
 
         printf ("\n\n");
 
-        for (t=0; t<NUM_SZS; t++)
+        for (t=0; t<E->numszs; t++)
         {
-            printf ("%6u", sizes[t]);
+            printf ("%6u", E->sizes[t]);
 
-            for (a=0; a<NUM_ALG; a++)
-                if (results[a][i][t]<1000000)
-                    printf (" %7u", results[a][i][t]);
+            for (a=0; a<E->numalg; a++)
+                if (E->results[a][i][t]<1000000)
+                    printf (" %7llu", E->results[a][i][t]);
                 else
-                    printf (" %7.1e", (float)results[a][i][t]);
+                    printf (" %7.1e", (double)E->results[a][i][t]);
 
             printf ("\n");
         }
     }
 
     printf ("\n");
+}
+
+// Function run by every worker: take the next cell, count its
+// operations, and so on until there are no cells left
+
+void * worker (void * arg)
+{
+    sexperiments * E = (sexperiments*) arg;
+    int cell, a, i, t;
+
+    for (;;)
+    {
+        pthread_mutex_lock (&E->lock);
+        cell = E->next++ * E->numshards + E->shard;
+        pthread_mutex_unlock (&E->lock);
+
+        if (cell>=E->numalg*E->numini*E->numszs)
+            break;
+
+        t = cell / (E->numalg*E->numini);
+        a = cell / E->numini % E->numalg;
+        i = cell % E->numini;
+
+        // Each cell is written by one single worker
+        E->results[a][i][t] = count_cell (E, a, i, t);
+    }
+
+    return NULL;
+}
+
+// Function that counts the operations of one experiment
+
+unsigned long long count_cell (sexperiments * E, int a, int i, int t)
+{
+    char command[800]; // Command for executing gen_trace
+    char path[200];    // Stored trace of the experiment
+    strace T;          // Trace coming from gen_trace
+    sref refs[TRACE_BLOCK];  // Block of operations of the trace
+    int n, j, ok;      // Operations in the block, index and flag
+    unsigned sz;       // Size of the array to sort
+
+    unsigned long long reads, writes, comparisons;  // Counters
+
+    sz = E->sizes[t];
+    reads = writes = comparisons = 0;
+
+    if (E->dir)
+    {
+        sprintf (path, "%s/%s-%s-%u.trc",
+                       E->dir, E->algorithms[a], E->initial[i], sz);
+
+        // Store the trace if it isn't there yet (under a
+        // temporary name, so that nobody maps it half written)
+        if (access(path,R_OK)!=0)
+        {
+            sprintf (command, "./gen_trace %s-o %s.%d "
+                              "%s %s %u && mv %s.%d %s",
+                              E->binary ? "-b " : "",
+                              path, (int)getpid(),
+                              E->algorithms[a], E->initial[i], sz,
+                              path, (int)getpid(), path);
+
+            printf ("Executing command: %s\n", command);
+
+            if (system(command)!=0)
+                fprintf (stderr, "ERROR storing %s\n", path);
+        }
+
+        printf ("Reading trace file: %s\n", path);
+
+        // Map the stored trace and read (and ignore) size
+        ok = trace_map (&T, path) == 0;
+    }
+    else
+    {
+        // Make command to invoke gen_trace
+        // (sprintf "prints" in a string)
+        sprintf (command, "./gen_trace %s%s %s %u",
+                          E->binary ? "-b " : "",
+                          E->algorithms[a], E->initial[i], sz);
+
+        printf ("Executing command: %s\n", command);
+
+        // Invoke gen_trace and read (and ignore) size
+        ok = trace_open (&T, command) == 0;
+    }
+
+    while (ok && (n=trace_read(&T,refs,TRACE_BLOCK)) != 0)
+    {
+        if (n<0)
+        {
+            ok = 0;
+            break;
+        }
+
+        for (j=0; j<n; j++)
+            if (refs[j].op=='R')      // Count reads,
+                reads ++;
+            else if (refs[j].op=='W') // writes
+                writes ++;
+            else                      // and comparisons
+                comparisons ++;
+    }
+
+    // Wait until gen_trace ends and close
+    if (trace_close(&T)<0)
+        ok = 0;
+
+    // Number of operations for the table
+    // (0 if an error occurred)
+    return ok ? reads + writes + comparisons : 0;
+}
+
+// Functions that parse the lists of the command line
+// (comma separated), returning how many items or -1
+
+int parse_names (char * list, const char * valid[], int numvalid,
+                 const char * names[])
+{
+    char * name;
+    int n, v;
+
+    for (n=0, name=strtok(list,","); name; name=strtok(NULL,","))
+    {
+        for (v=0; v<numvalid && strcmp(name,valid[v]); v++)
+            ;
+
+        if (v==numvalid || n==numvalid)  // Unknown, or too many
+        {
+            fprintf (stderr, "ERROR: wrong name \"%s\"\n", name);
+            return -1;
+        }
+
+        names[n++] = valid[v];
+    }
+
+    return n;
+}
+
+int parse_sizes (char * list, unsigned sizes[])
+{
+    char * size;
+    int n;
+
+    for (n=0, size=strtok(list,","); size; size=strtok(NULL,","))
+    {
+        if (n==MAX_SZS || sscanf(size,"%u",&sizes[n])!=1 ||
+            sizes[n]<2)
+        {
+            fprintf (stderr, "ERROR: wrong size \"%s\"\n", size);
+            return -1;
+        }
+
+        n ++;
+    }
+
+    return n;
+}
+
+// Functions that keep the results of a shard in a file: the
+// experiments of the whole matrix, which shard this is, and one
+// line for every cell of the shard, in the order of the cells.
+// The file is written under a temporary name, so that nobody
+// merges it half written
+
+static void format_matrix (sexperiments * E, char * line)
+{
+    int k;
+
+    line += sprintf (line, "matrix ");
+
+    for (k=0; k<E->numalg; k++)
+        line += sprintf (line, "%s%s", k ? "," : "", E->algorithms[k]);
+
+    line += sprintf (line, " ");
+
+    for (k=0; k<E->numini; k++)
+        line += sprintf (line, "%s%s", k ? "," : "", E->initial[k]);
+
+    line += sprintf (line, " ");
+
+    for (k=0; k<E->numszs; k++)
+        line += sprintf (line, "%s%u", k ? "," : "", E->sizes[k]);
+
+    sprintf (line, "\n");
+}
+
+int write_shard (sexperiments * E, const char * path)
+{
+    char line[1024];   // Line of the matrix
+    char tmp[4200];    // Temporary name of the file
+    FILE * f;
+    int cell, a, i, t, ok;
+
+    if (strlen(path)>4096)
+    {
+        fprintf (stderr, "ERROR: name too long \"%s\"\n", path);
+        return -1;
+    }
+
+    sprintf (tmp, "%s.%d", path, (int)getpid());
+
+    f = fopen (tmp, "w");
+
+    if (!f)
+    {
+        perror (tmp);
+        return -1;
+    }
+
+    format_matrix (E, line);
+    fprintf (f, "%s\n%sshard %d/%d\n", SHARD_MAGIC, line,
+             E->shard+1, E->numshards);
+
+    for (cell=E->shard; cell<E->numalg*E->numini*E->numszs;
+         cell+=E->numshards)
+    {
+        t = cell / (E->numalg*E->numini);
+        a = cell / E->numini % E->numalg;
+        i = cell % E->numini;
+
+        fprintf (f, "%s %s %u %llu\n", E->algorithms[a], E->initial[i],
+                 E->sizes[t], E->results[a][i][t]);
+    }
+
+    ok = !ferror(f);
+    ok = fclose(f)==0 && ok && rename(tmp,path)==0;
+
+    if (!ok)
+    {
+        perror (path);
+        remove (tmp);
+    }
+
+    return ok ? 0 : -1;
+}
+
+// Function that reads the results files of the shards into E:
+// the first one gives the matrix, and the rest must be shards
+// of the same one, each one once, until every cell has results
+
+static int find_name (const char * name, const char * names[], int n)
+{
+    int k;
+
+    for (k=0; k<n && strcmp(name,names[k]); k++)
+        ;
+
+    return k<n ? k : -1;
+}
+
+static int read_shard (sexperiments * E, const char * path, char * matrix,
+                       char * seen, int maxshards,
+                       char done[MAX_ALG][MAX_INI][MAX_SZS])
+{
+    char line[1024];   // Line of the file
+    char lists[3][400];     // Lists of the matrix
+    char alg[8], ini[8];    // Names of a cell
+    unsigned sz;            // Size of a cell
+    unsigned long long ops; // Result of a cell
+    int shard, numshards, a, i, t, ok;
+    FILE * f;
+
+    f = fopen (path, "r");
+
+    if (!f)
+    {
+        perror (path);
+        return -1;
+    }
+
+    ok = fgets(line,sizeof(line),f) && !strcmp(line,SHARD_MAGIC "\n") &&
+         fgets(line,sizeof(line),f) && !strncmp(line,"matrix ",7);
+
+    if (ok && !matrix[0])        // The first file
+    {
+        strcpy (matrix, line);
+
+        ok = sscanf(line,"matrix %399s %399s %399s",
+                    lists[0],lists[1],lists[2])==3 &&
+             (E->numalg=parse_names(lists[0],all_algorithms,MAX_ALG,
+                                    E->algorithms)) > 0 &&
+             (E->numini=parse_names(lists[1],all_initial,MAX_INI,
+                                    E->initial)) > 0 &&
+             (E->numszs=parse_sizes(lists[2],E->sizes)) > 0;
+    }
+    else if (ok && strcmp(line,matrix))
+    {
+        fprintf (stderr, "ERROR: %s is a shard of other experiments\n",
+                 path);
+        fclose (f);
+        return -1;
+    }
+
+    ok = ok && fgets(line,sizeof(line),f) &&
+         sscanf(line,"shard %d/%d",&shard,&numshards)==2 &&
+         shard>0 && shard<=numshards &&
+         (!E->numshards || numshards==E->numshards);
+
+    if (ok && numshards>maxshards)
+    {
+        fprintf (stderr, "ERROR: %d shards, and only %d files\n",
+                 numshards, maxshards);
+        fclose (f);
+        return -1;
+    }
+
+    if (ok && seen[shard-1])
+    {
+        fprintf (stderr, "ERROR: shard %d/%d twice (%s)\n",
+                 shard, numshards, path);
+        fclose (f);
+        return -1;
+    }
+
+    if (ok)
+    {
+        E->numshards = numshards;
+        seen[shard-1] = 1;
+    }
 
-    return 0;
+    // The cells, each one in its shard (and with operations: 0 is
+    // a failed one, see count_cell)
+    while (ok && fscanf(f,"%7s %7s %u %llu",alg,ini,&sz,&ops)==4)
+    {
+        a = find_name (alg, E->algorithms, E->numalg);
+        i = find_name (ini, E->initial, E->numini);
+
+        for (t=0; t<E->numszs && E->sizes[t]!=sz; t++)
+            ;
+
+        if (a<0 || i<0 || t==E->numszs || done[a][i][t] || !ops ||
+            (t*E->numalg*E->numini + a*E->numini + i) % numshards !=
+            shard-1)
+            ok = 0;
+        else
+        {
+            E->results[a][i][t] = ops;
+            done[a][i][t] = 1;
+        }
+    }
+
+    ok = ok && feof(f);
+
+    if (!ok)
+        fprintf (stderr, "ERROR: wrong results file %s\n", path);
+
+    fclose (f);
+
+    return ok ? 0 : -1;
 }
 
+int merge_shards (sexperiments * E, int numfiles, char * files[])
+{
+    char done[MAX_ALG][MAX_INI][MAX_SZS];  // Cells read
+    char matrix[1024]; // Line of the matrix of the first file
+    char * seen;       // Shards read
+    int k, a, i, t, ok;
+
+    // One file per shard (a shard can be empty, but its file is
+    // there), so there are no more shards than files
+    seen = (char*) calloc (numfiles, 1);
+
+    if (!seen)
+    {
+        fprintf (stderr, "ERROR: not enough dynamic memory\n");
+        return -1;
+    }
+
+    memset (done, 0, sizeof(done));
+    matrix[0] = '\0';
+    E->numshards = 0;
+    ok = 1;
+
+    for (k=0; ok && k<numfiles; k++)
+        ok = read_shard (E, files[k], matrix, seen, numfiles, done) == 0;
+
+    for (k=0; ok && k<E->numshards; k++)
+        if (!seen[k])
+        {
+            fprintf (stderr, "ERROR: shard %d/%d missing\n",
+                     k+1, E->numshards);
+            ok = 0;
+        }
+
+    for (t=0; ok && t<E->numszs; t++)
+        for (a=0; ok && a<E->numalg; a++)
+            for (i=0; ok && i<E->numini; i++)
+                if (!done[a][i][t])
+                {
+                    fprintf (stderr, "ERROR: no results for %s %s %u\n",
+                             E->algorithms[a], E->initial[i],
+                             E->sizes[t]);
+                    ok = 0;
+                }
+
+    free (seen);
+
+    return ok ? 0 : -1;
+}
@@ -5,23 +5,22 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <getopt.h>     // Not unistd.h: it'd clash with read/write
 
 #include "sort.h"
+#include "trace.h"
 
-// Functions that prepare the data according to
-// different criteria:
+// Largest array that can be sorted (the trace of a quadratic
+// algorithm gets huge long before this)
 
-typedef void function_prepare_data (thing A[], unsigned size);
-
-function_prepare_data ascending_order,
-                      descending_order,
-                      random_order;
+#define MAX_SIZE 1000000
 
 // Functions that the sorting algorithms should use in order
-// to access the data of the array:
+// to access the data of the array (static: they must not take
+// the place of read(2)/write(2) for the rest of the program):
 
-thing read (void *, unsigned pos);
-void write (void *, unsigned pos, thing value);
+static thing read (void *, unsigned pos);
+static void write (void *, unsigned pos, thing value);
 
 // Functions that the sorting algorithms should use in order
 // to compare values of the array:
@@ -35,10 +34,10 @@ int lesser_than_back_to_front (void *, thing a, thing b);
 typedef struct
 {
     thing * pdata;            // Array with data to be sorted
-    unsigned nreads;          // Read operations counter
-    unsigned nwrites;         // Write operations counter
-    unsigned ncomparisons;    // Comparisons counter
-    FILE * pf;                // Operations log
+    unsigned long long nreads;        // Read operations counter
+    unsigned long long nwrites;       // Write operations counter
+    unsigned long long ncomparisons;  // Comparisons counter
+    soutput * po;             // Operations log
 }
 scontrol;
 
@@ -50,6 +49,9 @@ typedef struct
     function_prepare_data * pprepare;
     function_sort * psort;
     int size;
+    char binary;
+    const char * output;      // Trace file (NULL = stdout)
+    int width;                // Operations per line (0 = one line)
 }
 sparameters;
 
@@ -65,13 +67,14 @@ int main (int argc, char * argv[])
     thing * A;         // Dynamic array with data to sort
     scontrol C;        // Struct controlling access to array
     sparameters P;     // Parameters
+    soutput O;         // Where the trace goes
     unsigned totalsz;  // Total # of elements (2*size in MER)
     unsigned u;
 
     if (parse_command(argc,argv,&P)<0)
         return -1;
 
-    totalsz = P.psort==merge_sort ? P.size*2 : P.size;
+    totalsz = sort_total_size (P.psort, P.size);
     A = (thing*) malloc (totalsz*sizeof(thing));
 
     if (!A)
@@ -81,6 +84,15 @@ int main (int argc, char * argv[])
         return -2;
     }
 
+    if (output_create(&O,P.output)<0)
+    {
+        free (A);
+        return -3;
+    }
+
+    O.binary = P.binary;
+    O.width = P.width;
+
     C.pdata = A;
 
     // Generate data in specified initial state
@@ -88,10 +100,10 @@ int main (int argc, char * argv[])
 
     // Reset counters
     C.nreads = C.nwrites = C.ncomparisons = 0;
-    C.pf = stdout;
+    C.po = &O;
 
     // Show total size
-    printf (" T%u\n", totalsz);
+    trace_put_header (&O, totalsz);
 
     // Sort data with specified algorithm
     P.psort (&C,
@@ -100,54 +112,52 @@ int main (int argc, char * argv[])
              read,
              write);
 
-    C.pf = NULL;
+    C.po = NULL;
 
     for (u=0; u<P.size-1; u++)
         if (lesser_than(&C,A[u+1],A[u]))
             break;
 
-    printf (" %s\n", u<P.size-1?"Out of order :-(":"Sorted ;-)");
+    trace_put_end (&O, u==P.size-1);
+
     free (A);
+
+    if (output_close(&O)<0)
+    {
+        perror (P.output ? P.output : "ERROR writing the trace");
+
+        if (P.output)
+            remove (P.output);  // Don't leave a truncated trace
+
+        return -4;
+    }
+
     return 0;
 }
 
 // Functions that the sorting algorithms should use in order
 // to access the data of the array:
 
-thing read (void * p, unsigned pos)
+static thing read (void * p, unsigned pos)
 {
     scontrol * pc = (scontrol*) p;
 
     pc->nreads ++;
 
-    if (pc->pf)
-    {
-        fprintf (pc->pf, " R%u", pos);
-
-        if (((pc->nreads+
-              pc->nwrites+
-              pc->ncomparisons) & 7) == 0)
-            fputc ('\n', pc->pf);
-    }
+    if (pc->po)
+        trace_put_op (pc->po, 'R', pos);
 
     return pc->pdata[pos];
 }
 
-void write (void * p, unsigned pos, thing value)
+static void write (void * p, unsigned pos, thing value)
 {
     scontrol * pc = (scontrol*) p;
 
     pc->nwrites ++;
 
-    if (pc->pf)
-    {
-        fprintf (pc->pf, " W%u", pos);
-
-        if (((pc->nreads+
-              pc->nwrites+
-              pc->ncomparisons) & 7) == 0)
-            fputc ('\n', pc->pf);
-    }
+    if (pc->po)
+        trace_put_op (pc->po, 'W', pos);
 
     pc->pdata[pos] = value;
 }
@@ -161,15 +171,8 @@ int lesser_than (void * p, thing a, thing b)
 
     pc->ncomparisons ++;
 
-    if (pc->pf)
-    {
-        fprintf (pc->pf, " C");
-
-        if (((pc->nreads+
-              pc->nwrites+
-              pc->ncomparisons) & 7) == 0)
-            fputc ('\n', pc->pf);
-    }
+    if (pc->po)
+        trace_put_op (pc->po, 'C', 0);
 
     return a < b;
 }
@@ -180,113 +183,54 @@ int lesser_than_back_to_front (void * p, thing a, thing b)
 
     pc->ncomparisons ++;
 
-    if (pc->pf)
-    {
-        fprintf (pc->pf, " C");
-
-        if (((pc->nreads+
-              pc->nwrites+
-              pc->ncomparisons) & 7) == 0)
-            fputc ('\n', pc->pf);
-    }
+    if (pc->po)
+        trace_put_op (pc->po, 'C', 0);
 
     return a > b;
 }
 
-// Functions that prepare the data according to
-// different criteria:
-
-void ascending_order (thing A[], unsigned size)
-{
-    unsigned u;
-
-    for (u=0; u<size; u++)
-        A[u] = u;
-}
-
-void descending_order (thing A[], unsigned size)
-{
-    unsigned u;
-
-    for (u=0; u<size; u++)
-        A[u] = size-u-1;
-}
-
-void random_order (thing A[], unsigned size)
-{
-    unsigned u, n;
-    thing tmp;
-
-    srand (0);
-
-    for (u=0; u<5; u++)
-        rand ();
-
-    ascending_order (A, size);
-
-    for (u=0; u<size-1; u++)
-    {
-        n = 1 + u + (unsigned)(rand() * (size-u-1.0) / RAND_MAX);
-
-        if (n>size-1)
-            n = size-1;
-
-        if (n!=u)
-        {
-            tmp = A[n];
-            A[n] = A[u];
-            A[u] = tmp;
-        }
-    }
-}
-
 // Function that parses the parameters received through the
 // command line:
 
 int parse_command (int argc, char * argv[],
                    sparameters * pPar)
 {
-    unsigned u;
-
-    struct
-    {
-        function_prepare_data * pfun;
-        const char * name;
-    }
-    G[] = { { ascending_order, "ASC" },
-            { descending_order, "DES" },
-            { random_order, "RAN" },
-            { NULL, NULL } };
-
-    struct
-    {
-        function_sort * pfun;
-        const char * name;
-    }
-    S[] = { { bubble_sort, "BUB" },
-            { insertion_sort, "INS" },
-            { selection_sort, "SEL" },
-            { heap_sort, "HEA" },
-            { comb_sort, "COM" },
-            { merge_sort, "MER" },
-            { quick_sort, "QUI" },
-            { quick_sort_pa, "QRP" },
-            { NULL, NULL } }	;
+    int u, opt;
 
     // Default parameters:
     pPar->pprepare = random_order;
     pPar->psort = merge_sort;
     pPar->size = 4;
+    pPar->binary = 0;
+    pPar->output = NULL;
+    pPar->width = 8;
+
+    // Options go before the positional parameters:
+    //     -b       emit the trace in compact binary format
+    //     -w n     operations per line in ASCII (0 = all in
+    //              one line; 8 by default)
+    //     -o file  store the trace in a file (to be replayed
+    //              later with the -f option of the consumers)
+
+    while ((opt=getopt(argc,argv,"bo:w:")) != -1)
+        if (opt=='b')
+            pPar->binary = 1;
+        else if (opt=='o')
+            pPar->output = optarg;
+        else if (opt=='w' && sscanf(optarg,"%d",&pPar->width)==1 &&
+                 pPar->width>=0)
+            ;
+        else
+            return -1;
+
+    argc -= optind-1;
+    argv += optind-1;
 
     if (argc>1)
     {
-        for (u=0; S[u].pfun; u++)
-            if (!strcmp(argv[1],S[u].name))
-                break;
+        pPar->psort = find_sort (argv[1]);
 
-        if (S[u].pfun)
-            pPar->psort = S[u].pfun;
-        else
+        if (!pPar->psort)
         {
             fprintf (stderr, "ERROR: Unknown sorting "
                              "algorithm \"%s\"\n", argv[1]);
@@ -296,13 +240,9 @@ int parse_command (int argc, char * argv[],
 
     if (argc>2)
     {
-        for (u=0; G[u].pfun; u++)
-            if (!strcmp(argv[2],G[u].name))
-                break;
+        pPar->pprepare = find_prepare (argv[2]);
 
-        if (G[u].pfun)
-            pPar->pprepare = G[u].pfun;
-        else
+        if (!pPar->pprepare)
         {
             fprintf (stderr, "ERROR: Unknown initial "
                              "state \"%s\"\n", argv[2]);
@@ -314,11 +254,11 @@ int parse_command (int argc, char * argv[],
     {
         u = sscanf (argv[3], "%d", &pPar->size);
 
-        if (u!=1 || pPar->size<2 || pPar->size>10000)
+        if (u!=1 || pPar->size<2 || pPar->size>MAX_SIZE)
         {
             fprintf (stderr, "ERROR: Wrong size (must be "
                              "a number ranging from 2 "
-                             "to 10000\n");
+                             "to %d\n", MAX_SIZE);
             return -1;
         }
     }
@@ -0,0 +1,365 @@
+/*
+    Copyright 2023 The Operating System Group at the UAH
+    sim_pag_arc.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./sim_paging.h"
+
+// Scan-resistant policies: a page referenced only once (the copy
+// of merge sort, every pass of selection sort...) doesn't push
+// out the ones referenced again and again, as it does with LRU.
+// Both keep the resident pages in queues of pages and, besides,
+// ghost queues with pages already out of memory (only their
+// number), to learn from the ones that are referenced again.
+//
+// ARC (Adaptive Replacement Cache, Megiddo and Modha):
+//   T1: resident, referenced once lately      (LRU)
+//   T2: resident, referenced at least twice   (LRU)
+//   B1, B2: ghosts of the ones evicted from T1 and T2
+//   A fault on a ghost of B1 means T1 is too small, and the
+//   target size of T1 (p) grows; one on B2, that it shrinks.
+//   |T1| + |T2| <= numframes, |T1| + |B1| <= numframes and
+//   |T1| + |T2| + |B1| + |B2| <= 2 numframes.
+//
+// 2Q (full version, Johnson and Shasha):
+//   A1in:  resident, first reference (FIFO, about 1/4 of frames)
+//   Am:    resident, referenced again after leaving A1in (LRU)
+//   A1out: ghosts of the ones evicted from A1in (FIFO, about
+//          1/2 of frames); a fault on them goes to Am
+
+#define NONE 0
+#define T1 1      // ARC
+#define T2 2
+#define B1 3
+#define B2 4
+#define A1IN 1    // 2Q
+#define AM 2
+#define A1OUT 3
+
+#define NUMQUEUES 5
+
+// Queues of pages: circular doubly linked lists through the
+// nodes of the pages, the most recently inserted first
+
+typedef struct {
+  int next, prev;
+  char queue;     // The one the page is in (or NONE)
+} snode;
+
+typedef struct {
+  snode* node;    // One for every page
+  int head[NUMQUEUES];
+  int size[NUMQUEUES];
+  int p;          // ARC: target size of T1
+  int kin, kout;  // 2Q: sizes of A1in and A1out
+  int loaded;     // Page loaded by the current fault (or -1)
+  char ghost;     // Queue of the page of the current fault
+  char discard;   // ARC: the victim leaves no ghost
+} squeues;
+
+static void queue_unlink(squeues* Q, int page) {
+  snode* n = &Q->node[page];
+  int q = n->queue;
+
+  if (n->next == page) {
+    Q->head[q] = -1;  // It was the only one
+  } else {
+    Q->node[n->prev].next = n->next;
+    Q->node[n->next].prev = n->prev;
+
+    if (Q->head[q] == page) Q->head[q] = n->next;
+  }
+
+  Q->size[q]--;
+  n->queue = NONE;
+}
+
+static void queue_push(squeues* Q, int q, int page) {
+  snode* n = &Q->node[page];
+  int head;
+
+  if (n->queue != NONE) queue_unlink(Q, page);
+
+  head = Q->head[q];
+
+  if (head == -1) {
+    n->next = n->prev = page;
+  } else {
+    n->next = head;
+    n->prev = Q->node[head].prev;
+    Q->node[n->prev].next = page;
+    Q->node[head].prev = page;
+  }
+
+  Q->head[q] = page;
+  Q->size[q]++;
+  n->queue = q;
+}
+
+static int queue_tail(squeues* Q, int q) {  // The oldest one
+  return Q->head[q] == -1 ? -1 : Q->node[Q->head[q]].prev;
+}
+
+static int queue_victim(ssystem* S, squeues* Q, int q) {
+  // The oldest one that can leave now, see read_ahead (-1 = none)
+  int page = queue_tail(Q, q), n;
+
+  for (n = Q->size[q]; n > 0 && PINNED(S, page); n--)
+    page = Q->node[page].prev;
+
+  return n > 0 ? page : -1;
+}
+
+// Functions that create and initialise the tables
+
+static int queues_create_tables(ssystem* S) {
+  squeues* Q;
+
+  // A single block, so that a plain free() releases everything
+  Q = (squeues*)arena_alloc(S->arena,
+                            sizeof(squeues) + S->numpags * sizeof(snode));
+
+  if (!Q) return -1;
+
+  Q->node = (snode*)(Q + 1);
+  S->data = Q;
+  return 0;
+}
+
+static void queues_init_tables(ssystem* S) {
+  squeues* Q = (squeues*)S->data;
+  int i;
+
+  for (i = 0; i < S->numpags; i++) Q->node[i].queue = NONE;
+
+  for (i = 0; i < NUMQUEUES; i++) {
+    Q->head[i] = -1;
+    Q->size[i] = 0;
+  }
+
+  Q->p = 0;
+  Q->kin = S->numframes / 4 > 1 ? S->numframes / 4 : 1;
+  Q->kout = S->numframes / 2 > 1 ? S->numframes / 2 : 1;
+  Q->loaded = -1;
+  Q->ghost = NONE;
+  Q->discard = 0;
+}
+
+// ARC
+
+static void arc_reference_page(ssystem* S, int page, char op) {
+  squeues* Q = (squeues*)S->data;
+
+  if (page == Q->loaded) {  // Already placed by the fault
+    Q->loaded = -1;
+    return;
+  }
+
+  // A hit: referenced again (unless it was read ahead)
+  if (!PAGE(S, page, prefetched)) queue_push(Q, T2, page);
+}
+
+static void arc_page_fault(ssystem* S, int page) {
+  squeues* Q = (squeues*)S->data;
+  int c = S->numframes;
+  int l1 = Q->size[T1] + Q->size[B1];
+  int l2 = Q->size[T2] + Q->size[B2];
+  int q = Q->node[page].queue;
+
+  Q->loaded = page;
+  Q->ghost = q;
+
+  if (q == B1) {         // T1 should have been bigger
+    Q->p += Q->size[B2] > Q->size[B1] ? Q->size[B2] / Q->size[B1] : 1;
+    if (Q->p > c) Q->p = c;
+  } else if (q == B2) {  // T2 should have been bigger
+    Q->p -= Q->size[B1] > Q->size[B2] ? Q->size[B1] / Q->size[B2] : 1;
+    if (Q->p < 0) Q->p = 0;
+  } else if (l1 >= c) {  // New page, and no room for it in L1
+    if (Q->size[T1] < c)  // (more than one with readahead)
+      while (Q->size[T1] + Q->size[B1] >= c && Q->size[B1] > 0)
+        queue_unlink(Q, queue_tail(Q, B1));
+    else
+      Q->discard = 1;
+  } else {               // And no room in the ghosts
+    for (; l1 + l2 >= 2 * c && Q->size[B2] > 0; l2--)
+      queue_unlink(Q, queue_tail(Q, B2));
+  }
+}
+
+static int arc_choose_page_to_be_replaced(ssystem* S, int newpage) {
+  squeues* Q = (squeues*)S->data;
+  int victim;
+  int t1 = queue_victim(S, Q, T1), t2 = queue_victim(S, Q, T2);
+
+  if (Q->discard && t1 != -1) {
+    victim = t1;
+    queue_unlink(Q, victim);
+  } else if (t2 == -1 ||
+             (t1 != -1 && (Q->size[T1] > Q->p ||
+                           (Q->ghost == B2 && Q->size[T1] == Q->p)))) {
+    victim = t1;
+    queue_push(Q, B1, victim);
+  } else {
+    victim = t2;
+    queue_push(Q, B2, victim);
+  }
+
+  Q->discard = 0;
+
+  if (S->detailed) {
+    printf("@ Choosing P %d (%s, |T1|=%d, |T2|=%d, p=%d) from M %d for "
+           "replacement\n", victim,
+           Q->node[victim].queue == B2 ? "LRU of T2" : "LRU of T1",
+           Q->size[T1], Q->size[T2], Q->p, PAGE(S, victim, frame));
+  }
+
+  return victim;
+}
+
+static void arc_load_page(ssystem* S, int page) {
+  squeues* Q = (squeues*)S->data;
+  int q = Q->node[page].queue;
+
+  // A ghost referenced again has been referenced twice
+  queue_push(Q, q == B1 || q == B2 ? T2 : T1, page);
+}
+
+static void arc_replace_page(ssystem* S, int victim, int newpage) {
+  arc_load_page(S, newpage);
+}
+
+static void arc_occupy_free_frame(ssystem* S, int frame, int page) {
+  arc_load_page(S, page);
+}
+
+// 2Q
+
+static void twoq_reference_page(ssystem* S, int page, char op) {
+  squeues* Q = (squeues*)S->data;
+
+  if (page == Q->loaded) {  // Already placed by the fault
+    Q->loaded = -1;
+    return;
+  }
+
+  // Hits in A1in don't count: they may be the same scan
+  if (Q->node[page].queue == AM) queue_push(Q, AM, page);
+}
+
+static void twoq_page_fault(ssystem* S, int page) {
+  squeues* Q = (squeues*)S->data;
+
+  Q->loaded = page;
+  Q->ghost = Q->node[page].queue;
+
+  // Out of A1out before making room, or it could leave it now
+  if (Q->ghost == A1OUT) queue_unlink(Q, page);
+}
+
+static int twoq_choose_page_to_be_replaced(ssystem* S, int newpage) {
+  squeues* Q = (squeues*)S->data;
+  int victim;
+  int a1 = queue_victim(S, Q, A1IN), am = queue_victim(S, Q, AM);
+
+  if (am == -1 || (a1 != -1 && Q->size[A1IN] > Q->kin)) {
+    victim = a1;
+    queue_push(Q, A1OUT, victim);
+
+    if (Q->size[A1OUT] > Q->kout) queue_unlink(Q, queue_tail(Q, A1OUT));
+  } else {
+    victim = am;
+    queue_unlink(Q, victim);
+  }
+
+  if (S->detailed) {
+    printf("@ Choosing P %d (%s, |A1in|=%d, |Am|=%d) from M %d for "
+           "replacement\n", victim,
+           Q->node[victim].queue == A1OUT ? "FIFO of A1in" : "LRU of Am",
+           Q->size[A1IN], Q->size[AM], PAGE(S, victim, frame));
+  }
+
+  return victim;
+}
+
+static void twoq_load_page(ssystem* S, int page) {
+  squeues* Q = (squeues*)S->data;
+
+  queue_push(Q, Q->ghost == A1OUT ? AM : A1IN, page);
+}
+
+static void twoq_replace_page(ssystem* S, int victim, int newpage) {
+  twoq_load_page(S, newpage);
+}
+
+static void twoq_occupy_free_frame(ssystem* S, int frame, int page) {
+  twoq_load_page(S, page);
+}
+
+// Functions that show results
+
+static void print_queue(squeues* Q, int q, const char* name) {
+  int page = Q->head[q];
+
+  printf("%-6s (%d):", name, Q->size[q]);
+
+  if (page != -1) {
+    do {
+      printf(" P%d", page);
+      page = Q->node[page].next;
+    } while (page != Q->head[q]);
+  }
+
+  printf("\n");
+}
+
+static void arc_print_replacement_report(ssystem* S) {
+  squeues* Q = (squeues*)S->data;
+
+  printf("ARC replacement policy, target size of T1: p = %d\n", Q->p);
+  printf("Queues (most recent first):\n");
+  print_queue(Q, T1, "T1");
+  print_queue(Q, T2, "T2");
+  print_queue(Q, B1, "B1");
+  print_queue(Q, B2, "B2");
+}
+
+static void twoq_print_replacement_report(ssystem* S) {
+  squeues* Q = (squeues*)S->data;
+
+  printf("2Q replacement policy, Kin = %d, Kout = %d\n", Q->kin, Q->kout);
+  printf("Queues (most recent first):\n");
+  print_queue(Q, A1IN, "A1in");
+  print_queue(Q, AM, "Am");
+  print_queue(Q, A1OUT, "A1out");
+}
+
+const spolicy policy_arc = {
+    .name = "ARC",
+    .create_tables = queues_create_tables,
+    .init_tables = queues_init_tables,
+    .reference_page = arc_reference_page,
+    .page_fault = arc_page_fault,
+    .read_ahead = arc_page_fault,
+    .choose_page_to_be_replaced = arc_choose_page_to_be_replaced,
+    .replace_page = arc_replace_page,
+    .occupy_free_frame = arc_occupy_free_frame,
+    .print_replacement_report = arc_print_replacement_report,
+};
+
+const spolicy policy_2q = {
+    .name = "2Q",
+    .create_tables = queues_create_tables,
+    .init_tables = queues_init_tables,
+    .reference_page = twoq_reference_page,
+    .page_fault = twoq_page_fault,
+    .read_ahead = twoq_page_fault,
+    .choose_page_to_be_replaced = twoq_choose_page_to_be_replaced,
+    .replace_page = twoq_replace_page,
+    .occupy_free_frame = twoq_occupy_free_frame,
+    .print_replacement_report = twoq_print_replacement_report,
+};
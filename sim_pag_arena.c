@@ -0,0 +1,99 @@
+/*
+    Copyright 2023 The Operating System Group at the UAH
+    sim_pag_arena.c
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "./sim_paging.h"
+
+// Arena of the tables of several systems (see sim_paging.h): a
+// list of chunks, handed out one after the other. The memory of a
+// chunk past the blocks handed out is always zero: it comes from
+// calloc(), and the blocks come back zeroed (arena_release clears
+// the block, arena_release_zeroed trusts the caller), so a reset
+// only rewinds the chunks. Every block starts with a header of
+// ARENA_ALIGN bytes, with its size.
+
+struct sarenachunk {
+  sarenachunk* next;
+  char* mem;           // ARENA_ALIGN bytes aligned
+  size_t size;         // Bytes in mem
+  size_t used;         // Handed out since the last reset
+};
+
+void* arena_alloc(sarena* A, size_t bytes) {
+  sarenachunk* C;
+  size_t size, span;
+  char* p;
+
+  if (!A) return calloc(1, bytes);
+
+  span = ARENA_ALIGN +
+         ((bytes + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1));
+
+  // The current chunk, or the next ones (kept from the last round)
+  for (C = A->cur; C && C->used + span > C->size; C = C->next) {
+  }
+
+  if (!C) {  // A new one, at the end of the list
+    size = span > ARENA_CHUNK ? span : ARENA_CHUNK;
+    C = (sarenachunk*)calloc(1, sizeof(sarenachunk) + size + ARENA_ALIGN);
+
+    if (!C) return NULL;
+
+    C->mem = (char*)(((size_t)(C + 1) + ARENA_ALIGN - 1) &
+                     ~(size_t)(ARENA_ALIGN - 1));
+    C->size = size;
+
+    if (A->last)
+      A->last->next = C;
+    else
+      A->first = C;
+
+    A->last = C;
+  }
+
+  A->cur = C;
+  p = C->mem + C->used;
+  C->used += span;
+
+  *(size_t*)p = bytes;  // Zero already, as the rest of the block
+  return p + ARENA_ALIGN;
+}
+
+void arena_release(sarena* A, void* p) {
+  char* block = (char*)p - ARENA_ALIGN;
+
+  if (!A)
+    free(p);
+  else if (p)  // Only what this block covers
+    memset(block, 0, ARENA_ALIGN + *(size_t*)block);
+}
+
+void arena_release_zeroed(sarena* A, void* p) {
+  if (!A)
+    free(p);
+  else if (p)  // The header; the caller cleared what it wrote
+    memset((char*)p - ARENA_ALIGN, 0, ARENA_ALIGN);
+}
+
+void arena_reset(sarena* A) {
+  sarenachunk* C;
+
+  for (C = A->first; C; C = C->next) C->used = 0;
+
+  A->cur = A->first;
+}
+
+void arena_free(sarena* A) {
+  sarenachunk *C, *next;
+
+  for (C = A->first; C; C = next) {
+    next = C->next;
+    free(C);
+  }
+
+  A->first = A->last = A->cur = NULL;
+}
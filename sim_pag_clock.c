@@ -0,0 +1,150 @@
+/*
+    Copyright 2023 The Operating System Group at the UAH
+    sim_pag_clock.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./sim_paging.h"
+
+// CLOCK: the frames are a circle, in their order in the frames
+// table, and the hand (S->hand) points to the next candidate.
+// A referenced page gets its bit cleared and the hand goes on;
+// the first one not referenced is the victim, and the hand stays
+// after it. It is the same as FIFO 2nd chance, without moving
+// frames around a list.
+//
+// Enhanced CLOCK (ECLOCK) also looks at the modified bit, and
+// prefers the classes (referenced, modified) in this order:
+// (0,0), (0,1), (1,0), (1,1), so that clean pages are evicted
+// before dirty ones and fewer pages have to be written back:
+//
+//   1. One turn looking for (0,0), without touching any bit.
+//   2. One turn looking for (0,1), clearing the reference bits
+//      of the ones skipped. If none, back to 1 (at most twice).
+
+#define NEXT(S, f) ((f) + 1 < (S)->numframes ? (f) + 1 : 0)
+
+// Function that initialises the tables
+
+static void clock_init_tables(ssystem* S) { S->hand = 0; }
+
+// Functions that simulate the hardware of the MMU
+
+static void clock_reference_page(ssystem* S, int page, char op) {
+  PAGE_SET(S, page, referenced, 1);
+}
+
+// Functions that simulate the operating system
+
+static int clock_choose_page_to_be_replaced(ssystem* S, int newpage) {
+  int page;
+
+  for (;; S->hand = NEXT(S, S->hand)) {
+    page = S->frt[S->hand].page;
+    S->victimsteps++;
+
+    if (PINNED(S, page)) continue;  // See read_ahead
+
+    if (!PAGE(S, page, referenced)) break;
+
+    if (S->detailed) {
+      printf("@ P %d in M %d has 2nd chance (referenced=1), clearing it\n",
+             page, S->hand);
+    }
+
+    PAGE_SET(S, page, referenced, 0);
+  }
+
+  if (S->detailed) {
+    printf("@ Choosing P %d (referenced=0) from M %d for replacement\n",
+           page, S->hand);
+  }
+
+  S->hand = NEXT(S, S->hand);  // The new page goes behind the hand
+
+  return page;
+}
+
+static int eclock_choose_page_to_be_replaced(ssystem* S, int newpage) {
+  int page, i;
+
+  for (;;) {
+    // 1. Not referenced, not modified: leave the bits alone
+    for (i = 0; i < S->numframes; i++, S->hand = NEXT(S, S->hand)) {
+      page = S->frt[S->hand].page;
+      S->victimsteps++;
+
+      if (PINNED(S, page)) continue;  // See read_ahead
+
+      if (!PAGE(S, page, referenced) && !PAGE(S, page, modified)) goto found;
+    }
+
+    // 2. Not referenced, modified: clear the reference bits
+    for (i = 0; i < S->numframes; i++, S->hand = NEXT(S, S->hand)) {
+      page = S->frt[S->hand].page;
+      S->victimsteps++;
+
+      if (PINNED(S, page)) continue;
+
+      if (!PAGE(S, page, referenced)) goto found;
+
+      PAGE_SET(S, page, referenced, 0);
+    }
+  }
+
+found:
+  if (S->detailed) {
+    printf("@ Choosing P %d (referenced=%d, modified=%d) from M %d for "
+           "replacement\n", page, PAGE(S, page, referenced),
+           PAGE(S, page, modified), S->hand);
+  }
+
+  S->hand = NEXT(S, S->hand);
+
+  return page;
+}
+
+// Functions that show results
+
+static void clock_print_frames_table(ssystem* S) {
+  int p, f;
+
+  printf("%10s %10s %10s %10s   %s\n", "FRAME", "Page", "Referenced",
+         "Modified", "");
+
+  for (f = 0; f < S->numframes; f++) {
+    p = S->frt[f].page;
+
+    if (p == -1)
+      printf("%8d   %8s   %8s   %8s   %s\n", f, "-", "-", "-",
+             f == S->hand ? "<- hand" : "");
+    else
+      printf("%8d   %8d   %8d   %8d   %s\n", f, p, PAGE(S, p, referenced),
+             PAGE(S, p, modified), f == S->hand ? "<- hand" : "");
+  }
+}
+
+static void clock_print_replacement_report(ssystem* S) {
+  printf("%s replacement policy, hand at M %d\n", S->policy->name, S->hand);
+}
+
+const spolicy policy_clock = {
+    .name = "CLOCK",
+    .init_tables = clock_init_tables,
+    .reference_page = clock_reference_page,
+    .choose_page_to_be_replaced = clock_choose_page_to_be_replaced,
+    .print_frames_table = clock_print_frames_table,
+    .print_replacement_report = clock_print_replacement_report,
+};
+
+const spolicy policy_eclock = {
+    .name = "ECLOCK",
+    .init_tables = clock_init_tables,
+    .reference_page = clock_reference_page,
+    .choose_page_to_be_replaced = eclock_choose_page_to_be_replaced,
+    .print_frames_table = clock_print_frames_table,
+    .print_replacement_report = clock_print_replacement_report,
+};
@@ -0,0 +1,785 @@
+/*
+    Copyright 2023 The Operating System Group at the UAH
+    sim_pag_common.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./sim_paging.h"
+
+// Replacement policies available
+
+const spolicy* const policies[] = {&policy_random, &policy_fifo,
+                                   &policy_fifo2ch, &policy_lru,
+                                   &policy_ws,     &policy_pff,
+                                   &policy_clock,  &policy_eclock,
+                                   &policy_arc,    &policy_2q,
+                                   &policy_opt,
+                                   NULL};
+
+const spolicy* find_policy(const char* name) {
+  int i;
+
+  for (i = 0; policies[i]; i++)
+    if (!strcmp(policies[i]->name, name)) return policies[i];
+
+  return NULL;
+}
+
+// Functions that create, initialise and free the tables
+
+#ifdef PGT_SOA
+
+static size_t pgt_bytes(int numpags) {
+  int numwords = (numpags + 63) / 64;
+
+  return 5 * numwords * sizeof(unsigned long long) +
+         numpags * (sizeof(int) + sizeof(unsigned));
+}
+
+static spgt* pgt_create(sarena* A, int numpags) {
+  spgt* P;
+
+  // A single block, so that a plain free() releases everything
+  P = (spgt*)arena_alloc(A, sizeof(spgt) + pgt_bytes(numpags));
+
+  if (!P) return NULL;
+
+  P->numwords = (numpags + 63) / 64;
+  P->present = (unsigned long long*)(P + 1);
+  P->modified = P->present + P->numwords;
+  P->referenced = P->modified + P->numwords;
+  P->prefetched = P->referenced + P->numwords;
+  P->cleaned = P->prefetched + P->numwords;
+  P->frame = (int*)(P->cleaned + P->numwords);
+  P->timestamp = (unsigned*)(P->frame + numpags);
+
+  return P;
+}
+
+static void pgt_release(sarena* A, spgt* P) {
+  // The bitsets and arrays are zero again (see free_tables), but
+  // the pointers to them
+  if (A && P) memset(P, 0, sizeof(spgt));
+
+  arena_release_zeroed(A, P);
+}
+
+int next_present_page(ssystem* S, int page) {
+  unsigned long long word;
+  int k;
+
+  if (page >= S->numpags) return S->numpags;
+
+  // The rest of the first word, then whole words
+  k = page >> 6;
+  word = S->pgt->present[k] & (~0ULL << (page & 63));
+
+  while (!word) {
+    if (++k == S->pgt->numwords) return S->numpags;
+    word = S->pgt->present[k];
+  }
+
+  return k * 64 + __builtin_ctzll(word);  // Bits past numpags are 0
+}
+
+#else
+
+static spgt* pgt_create(sarena* A, int numpags) {
+  return (spgt*)arena_alloc(A, numpags * sizeof(spage));
+}
+
+static void pgt_release(sarena* A, spgt* P) {
+  arena_release_zeroed(A, P);  // Zero again, see free_tables
+}
+
+int next_present_page(ssystem* S, int page) {
+  while (page < S->numpags && !S->pgt[page].present) page++;
+
+  return page;
+}
+
+#endif
+
+int create_tables(ssystem* S, unsigned totalsz) {
+  // Calculate total number of pages
+  S->numpags = (totalsz + S->pagsz - 1) / S->pagsz;
+
+  // Zeroed: no page is present yet
+  S->pgt = pgt_create(S->arena, S->numpags);
+  S->frt = (sframe*)arena_alloc(S->arena, S->numframes * sizeof(sframe));
+
+  if (S->tlbentries > 0)
+    S->tlb = tlb_create(S->arena, S->tlbentries, S->tlbways, S->tlbrandom);
+
+  if (S->profile) S->prof = prof_create(S->arena);
+
+  if (S->seriesinterval) S->series = series_create(S);
+
+  if (S->layoutkind && S->pgt && S->frt)
+    S->layout = layout_create(S->arena, S->layoutkind, S->layoutperlevel,
+                              S->numpags, S->numframes);
+
+  if (!S->pgt || !S->frt || (S->tlbentries > 0 && !S->tlb) ||
+      (S->layoutkind && !S->layout) || (S->profile && !S->prof) ||
+      (S->seriesinterval && !S->series) ||
+      (S->policy->create_tables && S->policy->create_tables(S) < 0)) {
+    free_tables(S);
+    return -1;
+  }
+
+  init_tables(S);
+  return 0;
+}
+
+void free_tables(ssystem* S) {
+  int i;
+
+  // From an arena, the page table goes back zeroed, as it came:
+  // the pages out of memory are zero already (see clear_page), so
+  // only the ones in the frames are cleared, not the whole table
+  if (S->arena && S->pgt && S->frt)
+    for (i = 0; i < S->numframes; i++)
+      if (S->frt[i].page != -1) clear_page(S, S->frt[i].page);
+
+  pgt_release(S->arena, S->pgt);
+  arena_release(S->arena, S->frt);
+  arena_release(S->arena, S->curve);   // A single block
+  arena_release(S->arena, S->data);    // Also
+  arena_release(S->arena, S->tlb);     // Also
+  arena_release(S->arena, S->layout);  // Also
+  arena_release(S->arena, S->prof);
+  series_close(S);  // With the last sample, if not closed yet
+
+  S->pgt = NULL;
+  S->frt = NULL;
+  S->curve = NULL;
+  S->data = NULL;
+  S->tlb = NULL;
+  S->layout = NULL;
+  S->prof = NULL;
+}
+
+void init_tables(ssystem* S) {
+  int i;
+
+  // The pages are reset already (the page table comes zeroed)
+
+  // Empty LRU stack
+  S->lru = -1;
+
+  // Reset LRU(t) time
+  S->clock = S->clockbase = 0;
+  S->lastfault = 0;
+
+  // Circular list of free frames
+  for (i = 0; i < S->numframes - 1; i++) {
+    S->frt[i].page = -1;
+    S->frt[i].next = i + 1;
+  }
+
+  S->frt[i].page = -1;  // Now i == numframes-1
+  S->frt[i].next = 0;   // Close circular list
+  S->listfree = i;      // Point to the last one
+
+  // Empty circular list of occupied frames
+  S->listoccupied = -1;
+
+  // Empty resident set
+  S->numresident = S->maxresident = 0;
+  S->sumresident = 0;
+
+  // No sequential stream yet, nothing pinned
+  S->rawindow = 0;
+  S->ralast = -2;
+  S->pinfirst = 0;
+  S->pinlast = -1;
+
+  // Nothing to clean
+  S->cleanhand = 0;
+  S->numdirty = 0;
+
+  if (S->tlb) tlb_reset(S->tlb);
+
+  S->victimsteps = 0;
+  if (S->prof) prof_reset(S->prof);
+
+  if (S->layout) layout_reset(S->layout);
+
+  // Same sequence as rand() without srand()
+  sim_srand(S, 1);
+
+  if (S->policy->init_tables) S->policy->init_tables(S);
+}
+
+// Functions that maintain the LRU stack (exact LRU, WS, PFF): a
+// circular doubly linked list of the occupied frames, threaded
+// through the next and prev fields of sframe. S->lru is the most
+// recently used frame, so the least recently used one is
+// S->frt[S->lru].prev.
+
+void lru_stack_unlink(ssystem* S, int frame) {
+  int prev = S->frt[frame].prev;
+  int next = S->frt[frame].next;
+
+  if (next == frame) {
+    S->lru = -1;  // It was the only one
+  } else {
+    S->frt[prev].next = next;
+    S->frt[next].prev = prev;
+
+    if (S->lru == frame) S->lru = next;
+  }
+}
+
+void lru_stack_push(ssystem* S, int frame) {
+  int head = S->lru;
+
+  if (head == -1) {
+    S->frt[frame].next = S->frt[frame].prev = frame;
+  } else {
+    S->frt[frame].next = head;
+    S->frt[frame].prev = S->frt[head].prev;
+    S->frt[S->frt[head].prev].next = frame;
+    S->frt[head].prev = frame;
+  }
+
+  S->lru = frame;
+}
+
+// Pseudo-random numbers: the additive feedback generator of
+// random() in glibc (r[i] = r[i-3] + r[i-31]), with its state in S
+// so that systems simulated at the same time don't interfere
+
+void sim_srand(ssystem* S, unsigned seed) {
+  int* r = S->randstate;
+  long hi, lo, word;
+  int i;
+
+  r[0] = seed ? seed : 1;
+
+  for (i = 1; i < 31; i++) {
+    // r[i] = 16807 * r[i-1] % 2147483647, without overflowing
+    hi = r[i - 1] / 127773;
+    lo = r[i - 1] % 127773;
+    word = 16807 * lo - 2836 * hi;
+    r[i] = word < 0 ? word + 2147483647 : word;
+  }
+
+  for (i = 31; i < 34; i++) r[i] = r[i - 31];
+
+  S->randpos = 34;
+
+  for (i = 0; i < 310; i++)  // Discard the first ones
+    sim_rand(S);
+}
+
+int sim_rand(ssystem* S) {
+  int* r = S->randstate;
+  int i = S->randpos++ % 34;
+
+  r[i] = (unsigned)r[(i + 3) % 34] + (unsigned)r[(i + 31) % 34];
+
+  return (unsigned)r[i] >> 1;
+}
+
+// Functions that simulate the hardware of the MMU (sim_mmu is
+// translate, timed if there is a profile)
+
+static unsigned translate(ssystem* S, unsigned virtual_addr, char op) {
+  unsigned physical_addr;
+  int page, frame, offset, fault;
+
+  page   = virtual_addr / S->pagsz;
+  offset = virtual_addr % S->pagsz;
+
+  if (page < 0 || page >= S->numpags) {
+    S->numillegalrefs++;
+    return ~0U;
+  }
+
+  // Without a TLB (or on a miss), the page table is read
+  fault = 0;
+
+  if (!S->tlb || !tlb_lookup(S->tlb, page)) {
+    if (S->layout) layout_walk(S->layout, page);
+
+    fault = !PAGE(S, page, present);
+
+    if (fault) handle_page_fault(S, virtual_addr);
+
+    if (S->tlb) {
+      if (S->detailed) printf("@ TLB miss for P%d\n", page);
+
+      tlb_insert(S->tlb, page);
+    }
+  }
+
+  frame = PAGE(S, page, frame);
+  physical_addr = frame * S->pagsz + offset;
+
+  reference_page(S, page, op);
+
+  if (S->detailed) {
+    printf("\t %c %u==P %d(M %d)+ %d\n", op, virtual_addr, page, frame, offset);
+  }
+
+  // Once referenced, so that the pages read ahead don't evict it
+  if (fault && S->readahead) read_ahead(S, page);
+
+  // No fault: time for the cleaner
+  if (!fault && S->lowwater) clean_page(S, page);
+
+  if (S->series && --S->series->countdown == 0) series_sample(S);
+
+  return physical_addr;
+}
+
+unsigned sim_mmu(ssystem* S, unsigned virtual_addr, char op) {
+  unsigned long long t0;
+  unsigned physical_addr;
+
+  if (!S->prof) return translate(S, virtual_addr, op);
+
+  t0 = PROF_TICKS();
+  physical_addr = translate(S, virtual_addr, op);
+  PROF_ADD(S->prof, PROF_MMU, t0);
+
+  return physical_addr;
+}
+
+void reference_page(ssystem* S, int page, char op) {
+  if (op == 'R') {              // If it's a read,
+    S->numrefsread++;           // count it
+  } else if (op == 'W') {       // If it's a write,
+    if (!PAGE(S, page, modified)) S->numdirty++;
+
+    if (PAGE(S, page, cleaned)) {  // Cleaned for nothing
+      PAGE_SET(S, page, cleaned, 0);
+      S->numcleanwasted++;
+    }
+
+    PAGE_SET(S, page, modified, 1);  // count it and mark the
+    S->numrefswrite++;               // page 'modified'
+  }
+
+  if (S->policy->reference_page) S->policy->reference_page(S, page, op);
+
+  // Timestamps about to run out (billions of references)
+  if (S->clock - S->clockbase >= STAMP_LIMIT) renormalize_timestamps(S);
+
+  if (PAGE(S, page, prefetched)) {  // Read ahead, and needed indeed
+    PAGE_SET(S, page, prefetched, 0);
+    S->numprefetchhits++;
+  }
+
+  S->sumresident += S->numresident;  // For the mean resident set
+}
+
+void renormalize_timestamps(ssystem* S) {
+  unsigned shift = STAMP(S), stamp;
+  int p;
+
+  for (p = next_present_page(S, 0); p < S->numpags;
+       p = next_present_page(S, p + 1))
+    if (PAGE(S, p, timestamp) < shift) shift = PAGE(S, p, timestamp);
+
+  if (shift < STAMP_LIMIT / 2) shift = STAMP_LIMIT / 2;
+
+  for (p = next_present_page(S, 0); p < S->numpags;
+       p = next_present_page(S, p + 1)) {
+    stamp = PAGE(S, p, timestamp);
+    PAGE_SET(S, p, timestamp, stamp > shift ? stamp - shift : 0);
+  }
+
+  S->clockbase += shift;
+
+  if (S->policy->renormalize_timestamps) S->policy->renormalize_timestamps(S);
+}
+
+// Functions that simulate the operating system
+
+// Function that loads a page in a free frame, or in the frame of a
+// victim if there are none
+
+static void load_page(ssystem* S, int page) {
+  int victim, frame, last;
+
+  if (S->listfree != -1) {
+    // There are free frames
+    last = S->listfree;
+    frame = S->frt[last].next;
+
+    if (frame == last) {
+      // Then, this is the last one left.
+      S->listfree = -1;
+    } else {
+      // Otherwise, bypass
+      S->frt[last].next = S->frt[frame].next;
+    }
+
+    occupy_free_frame(S, frame, page);
+
+  } else {
+    // There are not free frames
+    victim = choose_page_to_be_replaced(S, page);
+    replace_page(S, victim, page);
+  }
+}
+
+static void serve_page_fault(ssystem* S, unsigned virtual_addr) {
+  unsigned long long writebacks;
+  int page;
+
+  S->numpagefaults++;
+  page = virtual_addr / S->pagsz;
+
+  if (S->detailed) {
+    printf("@ PAGE_FAULT in P %d!\n", page);
+  }
+
+  writebacks = S->numpgwriteback;
+
+  // Variable allocation policies may release frames first
+  if (S->policy->page_fault) S->policy->page_fault(S, page);
+
+  load_page(S, page);
+
+  // Dirty victims are written back before loading the page
+  if (S->numpgwriteback != writebacks) S->numfaultswait++;
+}
+
+void handle_page_fault(ssystem* S, unsigned virtual_addr) {
+  unsigned long long t0;
+
+  if (!S->prof) {
+    serve_page_fault(S, virtual_addr);
+    return;
+  }
+
+  t0 = PROF_TICKS();
+  serve_page_fault(S, virtual_addr);
+  PROF_ADD(S->prof, PROF_FAULT, t0);
+}
+
+// Readahead: after a fault on page, the next pages that aren't
+// present are loaded too, as if they had just been referenced
+// (but not counted as references), through the same hooks of the
+// policy as a fault. In adaptive mode, only when the fault comes
+// right after the pages loaded by the previous one (a sequential
+// stream), with a window that starts at 2 pages and doubles with
+// every sequential fault.
+
+void read_ahead(ssystem* S, int page) {
+  int k, q;
+
+  k = S->readahead;
+
+  if (S->adaptive) {
+    if (page != S->ralast + 1)
+      S->rawindow = 0;
+    else if (S->rawindow == 0)
+      S->rawindow = 2;
+    else
+      S->rawindow *= 2;
+
+    if (S->rawindow > k) S->rawindow = k;
+
+    k = S->rawindow;
+  }
+
+  // This one and the ones loaded can't be victims (PINNED): at
+  // most numframes-1 of them, so that some other page can leave
+  if (k > S->numframes - 1) k = S->numframes - 1;
+
+  if (k > S->numpags - 1 - page) k = S->numpags - 1 - page;
+
+  S->pinfirst = page;
+
+  for (q = page + 1; q <= page + k; q++) {
+    if (PAGE(S, q, present)) continue;
+
+    if (S->detailed) printf("@ Reading ahead P%d\n", q);
+
+    S->pinlast = q - 1;
+
+    if (S->policy->read_ahead) S->policy->read_ahead(S, q);
+
+    load_page(S, q);
+    PAGE_SET(S, q, prefetched, 1);
+    PAGE_SET(S, q, timestamp, STAMP(S));
+    S->numprefetched++;
+  }
+
+  S->pinfirst = 0;
+  S->pinlast = -1;
+  S->ralast = page + (k > 0 ? k : 0);
+}
+
+// Pages read ahead and not referenced yet: at the end, they were
+// useless too, like the ones evicted unreferenced
+
+int prefetched_resident(ssystem* S) {
+  int p, n = 0;
+
+  for (p = next_present_page(S, 0); p < S->numpags;
+       p = next_present_page(S, p + 1))
+    n += PAGE(S, p, prefetched);
+
+  return n;
+}
+
+// Page cleaner: while there are less than lowwater frames free or
+// with a clean page, one dirty page is written back in advance
+// (but not evicted) at every reference without a fault, so that
+// its eviction doesn't wait for the disc. The cleaner goes round
+// the frames table, skipping the page being referenced.
+
+void clean_page(ssystem* S, int page) {
+  int frame, p;
+
+  if (S->numframes - S->numdirty >= S->lowwater) return;
+
+  if (S->numdirty == PAGE(S, page, modified)) return;  // Only this one
+
+  do {
+    frame = S->cleanhand;
+    S->cleanhand = frame + 1 < S->numframes ? frame + 1 : 0;
+    p = S->frt[frame].page;
+  } while (p == -1 || p == page || !PAGE(S, p, modified));
+
+  if (S->detailed)
+    printf("@ Cleaner writing modified P%d back (to disc) in advance\n", p);
+
+  PAGE_SET(S, p, modified, 0);
+  PAGE_SET(S, p, cleaned, 1);
+  S->numdirty--;
+  S->numcleaned++;
+}
+
+int choose_page_to_be_replaced(ssystem* S, int newpage) {
+  unsigned long long t0, steps;
+  int victim;
+
+  if (!S->prof) return S->policy->choose_page_to_be_replaced(S, newpage);
+
+  t0 = PROF_TICKS();
+  steps = S->victimsteps;
+  victim = S->policy->choose_page_to_be_replaced(S, newpage);
+  PROF_ADD(S->prof, PROF_VICTIM, t0);
+
+  if (S->victimsteps == steps) S->victimsteps++;  // No search
+
+  prof_victim(S->prof, S->victimsteps - steps);
+
+  return victim;
+}
+
+void replace_page(ssystem* S, int victim, int newpage) {
+  int frame;
+
+  frame = PAGE(S, victim, frame);
+
+  if (PAGE(S, victim, modified)) {
+    if (S->detailed)
+      printf(
+          "@ Writing modified P%d back (to disc) to "
+          "replace it\n",
+          victim);
+
+    S->numpgwriteback++;
+  }
+
+  if (S->detailed)
+    printf("@ Replacing victim P%d with P%d in F%d\n", victim, newpage, frame);
+
+  if (PAGE(S, victim, prefetched)) S->numprefetchuseless++;
+
+  if (PAGE(S, victim, modified)) S->numdirty--;
+
+  if (S->tlb) tlb_invalidate(S->tlb, victim);
+
+  if (S->layout) {
+    layout_unmap(S->layout, victim, frame);
+    layout_map(S->layout, newpage, frame);
+  }
+
+  // Remove victim from page table
+  clear_page(S, victim);
+
+  // Load new page in the frame
+  PAGE_SET(S, newpage, present, 1);
+  PAGE_SET(S, newpage, frame, frame);
+  PAGE_SET(S, newpage, modified, 0);
+  PAGE_SET(S, newpage, referenced, 0);
+  PAGE_SET(S, newpage, timestamp, 0);
+  PAGE_SET(S, newpage, prefetched, 0);
+  PAGE_SET(S, newpage, cleaned, 0);
+
+  // Update frame table
+  S->frt[frame].page = newpage;
+
+  if (S->policy->replace_page) S->policy->replace_page(S, victim, newpage);
+}
+
+void occupy_free_frame(ssystem* S, int frame, int page) {
+  if (S->detailed) printf("@ Storing P%d in F%d\n", page, frame);
+
+  // Update page table
+  PAGE_SET(S, page, present, 1);
+  PAGE_SET(S, page, frame, frame);
+  PAGE_SET(S, page, modified, 0);
+  PAGE_SET(S, page, referenced, 0);
+  PAGE_SET(S, page, timestamp, 0);
+  PAGE_SET(S, page, prefetched, 0);
+  PAGE_SET(S, page, cleaned, 0);
+
+  // Update frame table
+  S->frt[frame].page = page;
+
+  if (S->layout) layout_map(S->layout, page, frame);
+
+  if (++S->numresident > S->maxresident) S->maxresident = S->numresident;
+
+  if (S->policy->occupy_free_frame)
+    S->policy->occupy_free_frame(S, frame, page);
+}
+
+void release_frame(ssystem* S, int page) {
+  int frame;
+
+  frame = PAGE(S, page, frame);
+
+  if (S->policy->release_frame) S->policy->release_frame(S, frame, page);
+
+  if (PAGE(S, page, modified)) {
+    if (S->detailed)
+      printf("@ Writing modified P%d back (to disc) to release F%d\n", page,
+             frame);
+
+    S->numpgwriteback++;
+  }
+
+  if (S->detailed) printf("@ Releasing P%d from F%d\n", page, frame);
+
+  if (PAGE(S, page, prefetched)) S->numprefetchuseless++;
+
+  if (PAGE(S, page, modified)) S->numdirty--;
+
+  if (S->tlb) tlb_invalidate(S->tlb, page);
+
+  if (S->layout) layout_unmap(S->layout, page, frame);
+
+  // Remove page from page table
+  clear_page(S, page);
+
+  // Put the frame at the end of the circular list of free frames
+  S->frt[frame].page = -1;
+
+  if (S->listfree == -1) {
+    S->frt[frame].next = frame;
+  } else {
+    S->frt[frame].next = S->frt[S->listfree].next;
+    S->frt[S->listfree].next = frame;
+  }
+
+  S->listfree = frame;
+  S->numresident--;
+}
+
+// The entry of a page out of memory is all zero, as in a new page
+// table: nothing looks at the fields of the pages not present, and
+// so free_tables only has to clear the ones in the frames
+
+void clear_page(ssystem* S, int page) {
+  PAGE_SET(S, page, present, 0);
+  PAGE_SET(S, page, frame, 0);
+  PAGE_SET(S, page, modified, 0);
+  PAGE_SET(S, page, referenced, 0);
+  PAGE_SET(S, page, timestamp, 0);
+  PAGE_SET(S, page, prefetched, 0);
+  PAGE_SET(S, page, cleaned, 0);
+}
+
+// Functions that turn the counters into time
+
+static double access_time(ssystem* S) {
+  const scost* C = S->cost;
+  double hitratio = C->tlbhitratio;
+  double walk = 1;
+
+  if (S->layout && S->layout->walks)
+    walk = S->layout->accesses / (double)S->layout->walks;
+
+  if (S->tlb && S->tlb->hits + S->tlb->misses > 0)  // The one measured
+    hitratio = S->tlb->hits / (double)(S->tlb->hits + S->tlb->misses);
+  else if (C->tlbtime == 0)
+    return C->memtime;
+
+  // A miss walks the page table: more accesses to memory
+  return C->tlbtime + C->memtime + (1 - hitratio) * walk * C->memtime;
+}
+
+double simulated_time(ssystem* S) {
+  double refs = (double)S->numrefsread + S->numrefswrite;
+
+  return refs * access_time(S) + S->numpagefaults * S->cost->faulttime +
+         S->numpgwriteback * S->cost->writebacktime;
+}
+
+double effective_access_time(ssystem* S) {
+  double refs = (double)S->numrefsread + S->numrefswrite;
+
+  return refs ? simulated_time(S) / refs : 0;
+}
+
+// Functions that show results
+
+void print_page_table(ssystem* S) {
+  int p;
+
+  if (S->policy->print_page_table) {
+    S->policy->print_page_table(S);
+    return;
+  }
+
+  printf("%10s %10s %10s   %s\n", "PAGE", "Present", "Frame", "Modified");
+
+  for (p = 0; p < S->numpags; p++)
+    if (PAGE(S, p, present))
+      printf("%8d   %6d     %8d   %6d\n", p, PAGE(S, p, present),
+             PAGE(S, p, frame), PAGE(S, p, modified));
+    else
+      printf("%8d   %6d     %8s   %6s\n", p, PAGE(S, p, present), "-", "-");
+}
+
+void print_frames_table(ssystem* S) {
+  int p, f;
+
+  if (S->policy->print_frames_table) {
+    S->policy->print_frames_table(S);
+    return;
+  }
+
+  printf("%10s %10s %10s   %s\n", "FRAME", "Page", "Present", "Modified");
+
+  for (f = 0; f < S->numframes; f++) {
+    p = S->frt[f].page;
+
+    if (p == -1)
+      printf("%8d   %8s   %6s     %6s\n", f, "-", "-", "-");
+    else if (PAGE(S, p, present))
+      printf("%8d   %8d   %6d     %6d\n", f, p, PAGE(S, p, present),
+             PAGE(S, p, modified));
+    else
+      printf("%8d   %8d   %6d     %6s   ERROR!\n", f, p, PAGE(S, p, present),
+             "-");
+  }
+}
+
+void print_replacement_report(ssystem* S) {
+  if (S->policy->print_replacement_report)
+    S->policy->print_replacement_report(S);
+}
@@ -0,0 +1,172 @@
+/*
+    Copyright 2023 The Operating System Group at the UAH
+    sim_pag_curve.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./sim_paging.h"
+
+// The stack distance of a reference to page P is one plus the
+// number of different pages referenced since the previous
+// reference to P. Every page keeps a mark in the slot (time) of
+// its last reference, so that number is the count of marks after
+// that slot, which a Fenwick tree gives in O(log n). When the
+// slots run out, the marks (at most one per page) are packed at
+// the beginning again, which is O(1) amortized per reference.
+//
+// With LRU and n frames, a reference faults if its distance is
+// greater than n; the victim was dirty if the previous references
+// since the last write to the page were all hits (distances <= n).
+// Pages that are never referenced again are accounted for at the
+// end, as if they were referenced once more.
+
+static void tree_add(scurve* C, unsigned slot, int value) {
+  for (; slot <= C->numslots; slot += slot & -slot) C->tree[slot] += value;
+}
+
+static int tree_sum(scurve* C, unsigned slot) {  // Marks in 1..slot
+  int sum = 0;
+
+  for (; slot > 0; slot -= slot & -slot) sum += C->tree[slot];
+
+  return sum;
+}
+
+static void count_writebacks(scurve* C, int page, int dist) {
+  // With n frames in [sincewrite, dist-1], the page was evicted
+  // before this reference, and it was dirty: one write back
+  int from = C->sincewrite[page] > 1 ? C->sincewrite[page] : 1;
+
+  if (from < dist) {
+    C->wbdiff[from]++;
+    C->wbdiff[dist]--;
+  }
+}
+
+static void compact_slots(scurve* C) {
+  unsigned s, k, j;
+  int page;
+
+  for (s = 1, k = 0; s <= C->numslots; s++) {
+    page = C->slotpage[s];
+
+    if (page >= 0) {
+      C->slotpage[s] = -1;
+      C->slotpage[++k] = page;
+      C->last[page] = k;
+    }
+  }
+
+  // Rebuild the tree with one mark in each of the first k slots
+  for (s = 1; s <= C->numslots; s++) C->tree[s] = s <= k;
+
+  for (s = 1; s <= C->numslots; s++) {
+    j = s + (s & -s);
+    if (j <= C->numslots) C->tree[j] += C->tree[s];
+  }
+
+  C->now = k;
+}
+
+scurve* curve_create(sarena* A, int maxframes, int numpags) {
+  scurve* C;
+  unsigned numslots, p;
+  size_t words, counters;
+  int* block;
+
+  numslots = 2 * numpags > 1024 ? 2 * numpags : 1024;
+
+  // A single block, so that arena_release() releases everything
+  // (the 64-bit counters first, then the rest), all zeroed
+  counters = (maxframes + 2) * 2;
+  words = numpags * 2 + (numslots + 1) * 2;
+  C = (scurve*)arena_alloc(A, sizeof(scurve) + counters * sizeof(long long) +
+                                  words * sizeof(int));
+
+  if (!C) return NULL;
+
+  C->maxframes = maxframes;
+  C->numrefs = 0;
+  C->hist = (unsigned long long*)(C + 1);
+  C->wbdiff = (long long*)(C->hist + (maxframes + 2));
+  block = (int*)(C->wbdiff + (maxframes + 2));
+  C->last = (unsigned*)block;
+  C->sincewrite = (int*)(C->last + numpags);
+  C->tree = C->sincewrite + numpags;
+  C->slotpage = C->tree + (numslots + 1);
+  C->numslots = numslots;
+  C->now = 0;
+  C->marks = 0;
+
+  for (p = 0; p < numpags; p++) C->sincewrite[p] = maxframes + 1;
+
+  for (p = 0; p <= numslots; p++) C->slotpage[p] = -1;
+
+  return C;
+}
+
+void curve_reference(scurve* C, int page, char op) {
+  int dist;
+
+  C->numrefs++;
+
+  // Distance (maxframes+1 stands for "more than maxframes")
+  if (C->last[page] == 0) {
+    dist = C->maxframes + 1;  // First reference ever
+  } else {
+    dist = 1 + C->marks - tree_sum(C, C->last[page]);
+    if (dist > C->maxframes) dist = C->maxframes + 1;
+
+    // Remove the old mark
+    tree_add(C, C->last[page], -1);
+    C->slotpage[C->last[page]] = -1;
+    C->marks--;
+  }
+
+  if (dist <= C->maxframes) C->hist[dist]++;
+
+  count_writebacks(C, page, dist);
+
+  if (op == 'W')
+    C->sincewrite[page] = 0;
+  else if (dist > C->sincewrite[page])
+    C->sincewrite[page] = dist;
+
+  // Put the new mark
+  if (C->now == C->numslots) compact_slots(C);
+
+  C->last[page] = ++C->now;
+  C->slotpage[C->now] = page;
+  tree_add(C, C->now, 1);
+  C->marks++;
+}
+
+void curve_print(scurve* C) {
+  unsigned long long faults = C->numrefs;
+  long long writebacks = 0;
+  int n;
+  unsigned s;
+  int dist;
+
+  // Pages evicted after their last reference (only once, when
+  // printing the results at the end of the simulation)
+  for (s = 1; s <= C->now; s++)
+    if (C->slotpage[s] >= 0) {
+      dist = 1 + C->marks - tree_sum(C, s);
+      if (dist > C->maxframes) dist = C->maxframes + 1;
+
+      count_writebacks(C, C->slotpage[s], dist);
+    }
+
+  printf("LRU fault curve (stack distances, one pass):\n");
+  printf("%10s %15s %20s\n", "FRAMES", "Page faults", "Page dumps to disc");
+
+  for (n = 1; n <= C->maxframes; n++) {
+    faults -= C->hist[n];
+    writebacks += C->wbdiff[n];
+    printf("%10d %15llu %20lld\n", n, faults, writebacks);
+  }
+}
@@ -9,115 +9,16 @@
 
 #include "./sim_paging.h"
 
-// Function that initialises the tables
-
-void init_tables(ssystem* S) {
-  int i;
-
-  // Reset pages
-  memset(S->pgt, 0, sizeof(spage) * S->numpags);
-
-  // Empty LRU stack
-  S->lru = -1;
-
-  // Reset LRU(t) time
-  S->clock = 0;
-
-  // Circular list of free frames
-  for (i = 0; i < S->numframes - 1; i++) {
-    S->frt[i].page = -1;
-    S->frt[i].next = i + 1;
-  }
-
-  S->frt[i].page = -1;  // Now i == numframes-1
-  S->frt[i].next = 0;   // Close circular list
-  S->listfree = i;      // Point to the last one
-
-  // Empty circular list of occupied frames
-  S->listoccupied = -1;
-}
-
 // Functions that simulate the hardware of the MMU
 
-unsigned sim_mmu(ssystem* S, unsigned virtual_addr, char op) {
-  unsigned physical_addr;
-  int page, frame, offset;
-
-  page   = virtual_addr / S->pagsz;
-  offset = virtual_addr % S->pagsz;
-
-  if (page < 0 || page >= S->numpags) {
-    S->numillegalrefs++;
-    return ~0U;
-  }
-  
-  if (!S->pgt[page].present)
-    handle_page_fault(S, virtual_addr);
-    
-  frame = S->pgt[page].frame;
-  physical_addr = frame * S->pagsz + offset;
-  
-  reference_page(S, page, op);
-  
-  if (S->detailed) {
-    printf("\t %c %u==P %d(M %d)+ %d\n", op, virtual_addr, page, frame, offset);
-  }
-
-  return physical_addr;
-}
-
-void reference_page(ssystem* S, int page, char op) {
-  // Increment read or write counter
-  if (op == 'R') {
-    S->numrefsread++;
-  } else {
-    S->numrefswrite++;
-  }
-  
-  // If it's a write, mark page as modified
-  if (op == 'W') {
-    S->pgt[page].modified = 1;
-  }
-  
+static void fifo2ch_reference_page(ssystem* S, int page, char op) {
   // FIFO 2nd chance: Mark page as referenced
-  S->pgt[page].referenced = 1;
+  PAGE_SET(S, page, referenced, 1);
 }
 
 // Functions that simulate the operating system
 
-void handle_page_fault(ssystem* S, unsigned virtual_addr) {
-  int page, victim, frame, last;
-
-  S->numpagefaults++;
-  page = virtual_addr / S->pagsz;
-  
-  if (S->detailed) {
-    printf("@ PAGE_FAULT in P %d!\n", page);
-  }
-  
-  if (S->listfree != -1) {
-    // There are free frames
-    last = S->listfree;
-    frame = S->frt[last].next;
-    
-    if (frame == last) {
-      // Then, this is the last one left.
-      S->listfree = -1;
-    } else {
-      // Otherwise, bypass
-      S->frt[last].next = S->frt[frame].next;
-    }
-    
-    occupy_free_frame(S, frame, page);
-    
-  } else {
-    // There are not free frames
-    victim = choose_page_to_be_replaced(S);
-    replace_page(S, victim, page);
-  }
-}
-
-int choose_page_to_be_replaced(ssystem* S) {
+static int fifo2ch_choose_page_to_be_replaced(ssystem* S, int newpage) {
   int candidate_frame;
   int candidate_page;
   int loops = 0;  // Safety counter to avoid infinite loops
@@ -126,15 +27,17 @@ int choose_page_to_be_replaced(ssystem* S) {
   candidate_frame = S->frt[S->listoccupied].next;
   candidate_page = S->frt[candidate_frame].page;
   
-  // Loop until we find a page with referenced bit = 0
-  while (S->pgt[candidate_page].referenced == 1 && loops < S->numframes * 2) {
-    if (S->detailed) {
+  // Loop until we find a page with referenced bit = 0 (and not
+  // pinned by read_ahead, which only goes to the end of the queue)
+  while ((PAGE(S, candidate_page, referenced) == 1 ||
+          PINNED(S, candidate_page)) && loops < S->numframes * 2) {
+    if (S->detailed && !PINNED(S, candidate_page)) {
       printf("@ P %d in M %d has 2nd chance (referenced=1), setting to 0 and skipping\n",
              candidate_page, candidate_frame);
     }
     
     // Give second chance: clear referenced bit
-    S->pgt[candidate_page].referenced = 0;
+    if (!PINNED(S, candidate_page)) PAGE_SET(S, candidate_page, referenced, 0);
     
     // Move to the end of the queue (it gets a second chance)
     S->listoccupied = candidate_frame;
@@ -145,6 +48,8 @@ int choose_page_to_be_replaced(ssystem* S) {
     
     loops++;
   }
+
+  S->victimsteps += loops + 1;  // Frames looked at
   
   if (S->detailed) {
     printf("@ Choosing P %d (referenced=0) from M %d for replacement\n",
@@ -154,54 +59,13 @@ int choose_page_to_be_replaced(ssystem* S) {
   return candidate_page;
 }
 
-void replace_page(ssystem* S, int victim, int newpage) {
-  int frame;
-  
-  frame = S->pgt[victim].frame;
-  
-  if (S->detailed) {
-    if (S->pgt[victim].modified) {
-      printf("@ Writing back modified P %d to disk for replacement\n", victim);
-    }
-    printf("@ Replacing victim P %d with P %d in M %d\n", victim, newpage, frame);
-  }
-  
-  // Update counter if page was modified
-  if (S->pgt[victim].modified) {
-    S->numpgwriteback++;
-  }
-  
-  // Remove victim from page table
-  S->pgt[victim].present = 0;
-  S->pgt[victim].frame = -1;
-  S->pgt[victim].modified = 0;
-  
-  // Load new page in the frame
-  S->pgt[newpage].present = 1;
-  S->pgt[newpage].frame = frame;
-  S->pgt[newpage].modified = 0;
-  S->pgt[newpage].referenced = 0;
-  S->pgt[newpage].timestamp = 0;
-  
-  // Update frame table
-  S->frt[frame].page = newpage;
-  
+static void fifo2ch_replace_page(ssystem* S, int victim, int newpage) {
   // FIFO: Move this frame to the end of the circular list
   // (it's now the "newest" since it just got a new page)
-  S->listoccupied = frame;
+  S->listoccupied = PAGE(S, newpage, frame);
 }
 
-void occupy_free_frame(ssystem* S, int frame, int page) {
-  // Update page table
-  S->pgt[page].present = 1;
-  S->pgt[page].frame = frame;
-  S->pgt[page].modified = 0;
-  S->pgt[page].referenced = 0;
-  S->pgt[page].timestamp = 0;
-  
-  // Update frame table
-  S->frt[frame].page = page;
-  
+static void fifo2ch_occupy_free_frame(ssystem* S, int frame, int page) {
   // FIFO: Add frame to the circular list of occupied frames
   if (S->listoccupied == -1) {
     // First frame in the list - points to itself
@@ -213,15 +77,11 @@ void occupy_free_frame(ssystem* S, int frame, int page) {
     S->frt[S->listoccupied].next = frame;
     S->listoccupied = frame;  // Update last element pointer
   }
-  
-  if (S->detailed) {
-    printf("@ Lodging P %d in M %d\n", page, frame);
-  }
 }
 
 // Functions that show results
 
-void print_page_table(ssystem* S) {
+static void fifo2ch_print_page_table(ssystem* S) {
   int i;
   
   printf("---------- PAGE TABLE ----------\n");
@@ -230,22 +90,22 @@ void print_page_table(ssystem* S) {
   for (i = 0; i < S->numpags; i++) {
     printf("%4d    ", i);
     
-    if (S->pgt[i].present) {
+    if (PAGE(S, i, present)) {
       printf("%4d     %4d      %4d        %4d\n",
-             S->pgt[i].present,
-             S->pgt[i].frame,
-             S->pgt[i].modified,
-             S->pgt[i].referenced);
+             PAGE(S, i, present),
+             PAGE(S, i, frame),
+             PAGE(S, i, modified),
+             PAGE(S, i, referenced));
     } else {
       printf("%4d        -         -           -\n",
-             S->pgt[i].present);
+             PAGE(S, i, present));
     }
   }
   
   printf("-----------------------------------\n");
 }
 
-void print_frames_table(ssystem* S) {
+static void fifo2ch_print_frames_table(ssystem* S) {
   int i, frame;
   
   printf("---------- FRAMES TABLE ----------\n");
@@ -258,9 +118,9 @@ void print_frames_table(ssystem* S) {
       int page = S->frt[i].page;
       printf("%4d     %4d      %4d        %4d       ",
              page,
-             S->pgt[page].present,
-             S->pgt[page].modified,
-             S->pgt[page].referenced);
+             PAGE(S, page, present),
+             PAGE(S, page, modified),
+             PAGE(S, page, referenced));
       
       // Show FIFO position
       int pos = 1;
@@ -278,7 +138,7 @@ void print_frames_table(ssystem* S) {
   printf("------------------------------------------\n");
 }
 
-void print_replacement_report(ssystem* S) {
+static void fifo2ch_print_replacement_report(ssystem* S) {
   int frame, count = 0;
   
   printf("--------- REPLACEMENT REPORT ---------\n");
@@ -293,7 +153,7 @@ void print_replacement_report(ssystem* S) {
       printf("  M %d -> P %d (ref=%d)%s\n",
              frame,
              page,
-             S->pgt[page].referenced,
+             PAGE(S, page, referenced),
              (frame == S->frt[S->listoccupied].next) ? " (next candidate)" : "");
       frame = S->frt[frame].next;
       count++;
@@ -301,5 +161,16 @@ void print_replacement_report(ssystem* S) {
   }
   
   printf("--------------------------------------\n");
-  printf("PAGE FAULTS: --->> %d <<---\n", S->numpagefaults);
+  printf("PAGE FAULTS: --->> %llu <<---\n", S->numpagefaults);
 }
+
+const spolicy policy_fifo2ch = {
+    .name = "FIFO2CH",
+    .reference_page = fifo2ch_reference_page,
+    .choose_page_to_be_replaced = fifo2ch_choose_page_to_be_replaced,
+    .replace_page = fifo2ch_replace_page,
+    .occupy_free_frame = fifo2ch_occupy_free_frame,
+    .print_page_table = fifo2ch_print_page_table,
+    .print_frames_table = fifo2ch_print_frames_table,
+    .print_replacement_report = fifo2ch_print_replacement_report,
+};
@@ -0,0 +1,148 @@
+/*
+    Copyright 2023 The Operating System Group at the UAH
+    sim_pag_layout.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./sim_paging.h"
+
+// Layouts of the page table that the OS would keep for the
+// translation (the simulator keeps its flat S->pgt anyway, as the
+// state of every page), to compare the memory they need and the
+// accesses to memory of every walk (every reference, or every TLB
+// miss):
+//
+//   FLAT:  one entry per page of the virtual space; 1 access.
+//   2L:    a directory with one entry per second-level table of
+//          perlevel entries, allocated when a page of its range is
+//          loaded, and freed when the last one leaves; 2 accesses
+//          (1 if the directory says there is no table).
+//   INV:   inverted table, one entry per frame, with the pages
+//          hashed into numbuckets chains; 1 access to the bucket
+//          plus one per entry of the chain visited.
+
+#define PTE_BYTES LAYOUT_PTE_BYTES
+#define IPTE_BYTES 16 // Entry of the inverted table (page, frame
+                      // and next in the chain)
+#define BUCKET_BYTES 4
+
+slayout* layout_create(sarena* A, char kind, int perlevel, int numpags,
+                       int numframes) {
+  slayout* L;
+  size_t words;
+  int numtables = (numpags + perlevel - 1) / perlevel;
+  int numbuckets;
+
+  for (numbuckets = 1; numbuckets < numframes; numbuckets *= 2)
+    ;
+
+  if (kind == LAYOUT_2L)
+    words = numtables;
+  else if (kind == LAYOUT_INV)
+    words = numbuckets + 2 * numframes;
+  else
+    words = 0;
+
+  // A single block, so that arena_release() releases everything
+  L = (slayout*)arena_alloc(A, sizeof(slayout) + words * sizeof(int));
+
+  if (!L) return NULL;
+
+  L->kind = kind;
+  L->perlevel = perlevel;
+  L->numpags = numpags;
+  L->numtables = numtables;
+  L->numbuckets = numbuckets;
+  L->numframes = numframes;
+  L->count = (int*)(L + 1);
+  L->bucket = (int*)(L + 1);
+  L->ipage = L->bucket + numbuckets;
+  L->inext = L->ipage + numframes;
+
+  layout_reset(L);
+  return L;
+}
+
+void layout_reset(slayout* L) {
+  int i;
+
+  L->walks = L->accesses = 0;
+
+  if (L->kind == LAYOUT_2L) {
+    for (i = 0; i < L->numtables; i++) L->count[i] = 0;
+
+    L->bytes = (size_t)L->numtables * PTE_BYTES;  // The directory
+  } else if (L->kind == LAYOUT_INV) {
+    for (i = 0; i < L->numbuckets; i++) L->bucket[i] = -1;
+
+    L->bytes = (size_t)L->numbuckets * BUCKET_BYTES +
+               (size_t)L->numframes * IPTE_BYTES;
+  } else {
+    L->bytes = (size_t)L->numpags * PTE_BYTES;
+  }
+
+  L->peakbytes = L->bytes;
+}
+
+static int hash(slayout* L, int page) {
+  return (unsigned)page * 2654435761U % L->numbuckets;  // Knuth
+}
+
+void layout_walk(slayout* L, int page) {
+  int f;
+
+  L->walks++;
+
+  if (L->kind == LAYOUT_2L) {
+    L->accesses += L->count[page / L->perlevel] ? 2 : 1;
+  } else if (L->kind == LAYOUT_INV) {
+    L->accesses++;
+
+    for (f = L->bucket[hash(L, page)]; f != -1; f = L->inext[f]) {
+      L->accesses++;
+
+      if (L->ipage[f] == page) break;
+    }
+  } else {
+    L->accesses++;
+  }
+}
+
+void layout_map(slayout* L, int page, int frame) {
+  int b;
+
+  if (L->kind == LAYOUT_2L) {
+    if (L->count[page / L->perlevel]++ == 0) {
+      L->bytes += (size_t)L->perlevel * PTE_BYTES;
+
+      if (L->bytes > L->peakbytes) L->peakbytes = L->bytes;
+    }
+  } else if (L->kind == LAYOUT_INV) {
+    b = hash(L, page);
+    L->ipage[frame] = page;
+    L->inext[frame] = L->bucket[b];
+    L->bucket[b] = frame;
+  }
+}
+
+void layout_unmap(slayout* L, int page, int frame) {
+  int* pf;
+
+  if (L->kind == LAYOUT_2L) {
+    if (--L->count[page / L->perlevel] == 0)
+      L->bytes -= (size_t)L->perlevel * PTE_BYTES;
+  } else if (L->kind == LAYOUT_INV) {
+    for (pf = &L->bucket[hash(L, page)]; *pf != frame; pf = &L->inext[*pf])
+      ;
+
+    *pf = L->inext[frame];
+  }
+}
+
+const char* layout_name(slayout* L) {
+  return L->kind == LAYOUT_2L ? "two-level"
+                              : L->kind == LAYOUT_INV ? "inverted" : "flat";
+}
@@ -9,189 +9,250 @@
 
 #include "./sim_paging.h"
 
-// Function that initialises the tables
+#if !defined(LRU_NO_SIMD) && defined(__AVX2__)
+#include <immintrin.h>
+#elif !defined(LRU_NO_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// LRU(t) searches the page with the lowest timestamp. Instead of
+// going over the page table, the timestamps of the pages loaded
+// are also kept by frame (S->data, stamp[frame]), so the search
+// covers numframes contiguous words, 8 (AVX2) or 4 (SSE2) at a
+// time, or one by one if the compiler doesn't offer them (or with
+// -DLRU_NO_SIMD). One pass finds the minimum and another one the
+// frames that hold it: among them, the lowest page is the victim,
+// the same one as the search over the page table. Empty frames
+// are ~0U, which is never chosen.
+//
+// A page loaded in a frame gets S->clock: the reference that
+// follows gives the same value to a page loaded on demand, and
+// read_ahead gives it to a page read ahead.
+
+#define EMPTY ~0U
+
+static unsigned min_stamp(const unsigned* stamp, int n) {
+  unsigned min = EMPTY;
+  int i = 0;
+
+#if !defined(LRU_NO_SIMD) && defined(__AVX2__)
+  unsigned lane[8];
+  __m256i vmin = _mm256_set1_epi32(-1);
+
+  for (; i + 8 <= n; i += 8)
+    vmin = _mm256_min_epu32(
+        vmin, _mm256_loadu_si256((const __m256i*)(stamp + i)));
+
+  _mm256_storeu_si256((__m256i*)lane, vmin);
+  for (int k = 0; k < 8; k++)
+    if (lane[k] < min) min = lane[k];
+#elif !defined(LRU_NO_SIMD) && defined(__SSE2__)
+  // No unsigned comparison in SSE2: flip the sign bit, compare
+  // signed and select
+  unsigned lane[4];
+  __m128i sign = _mm_set1_epi32((int)0x80000000);
+  __m128i vmin = _mm_set1_epi32(0x7FFFFFFF);  // EMPTY, flipped
+  __m128i v, less;
+
+  for (; i + 4 <= n; i += 4) {
+    v = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(stamp + i)), sign);
+    less = _mm_cmplt_epi32(v, vmin);
+    vmin = _mm_or_si128(_mm_and_si128(less, v), _mm_andnot_si128(less, vmin));
+  }
 
-void init_tables(ssystem* S) {
-  int i;
+  _mm_storeu_si128((__m128i*)lane, _mm_xor_si128(vmin, sign));
+  for (int k = 0; k < 4; k++)
+    if (lane[k] < min) min = lane[k];
+#endif
 
-  // Reset pages
-  memset(S->pgt, 0, sizeof(spage) * S->numpags);
+  for (; i < n; i++)
+    if (stamp[i] < min) min = stamp[i];
 
-  // Empty LRU stack
-  S->lru = -1;
+  return min;
+}
 
-  // Reset LRU(t) time
-  S->clock = 0;
+static int find_stamp(const unsigned* stamp, int n, int i, unsigned value) {
+  // First frame from i on with that timestamp (n = none)
+#if !defined(LRU_NO_SIMD) && defined(__AVX2__)
+  __m256i v = _mm256_set1_epi32((int)value);
+  int mask;
 
-  // Circular list of free frames
-  for (i = 0; i < S->numframes - 1; i++) {
-    S->frt[i].page = -1;
-    S->frt[i].next = i + 1;
+  for (; i + 8 <= n; i += 8) {
+    mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(
+        v, _mm256_loadu_si256((const __m256i*)(stamp + i)))));
+    if (mask) return i + __builtin_ctz(mask);
   }
+#elif !defined(LRU_NO_SIMD) && defined(__SSE2__)
+  __m128i v = _mm_set1_epi32((int)value);
+  int mask;
+
+  for (; i + 4 <= n; i += 4) {
+    mask = _mm_movemask_ps(_mm_castsi128_ps(
+        _mm_cmpeq_epi32(v, _mm_loadu_si128((const __m128i*)(stamp + i)))));
+    if (mask) return i + __builtin_ctz(mask);
+  }
+#endif
 
-  S->frt[i].page = -1;  // Now i == numframes-1
-  S->frt[i].next = 0;   // Close circular list
-  S->listfree = i;      // Point to the last one
+  for (; i < n && stamp[i] != value; i++) continue;
 
-  // Empty circular list of occupied frames
-  S->listoccupied = -1;
+  return i;
 }
 
-// Functions that simulate the hardware of the MMU
-
-unsigned sim_mmu(ssystem* S, unsigned virtual_addr, char op) {
-  unsigned physical_addr;
-  int page, frame, offset;
+// Functions that create, initialise and renormalize the tables
 
-  page   = virtual_addr / S->pagsz;
-  offset = virtual_addr % S->pagsz;
+static int lru_create_tables(ssystem* S) {
+  // Fault curve for 1..curvemax frames, if requested
+  if (S->curvemax > 0) {
+    S->curve = curve_create(S->arena, S->curvemax, S->numpags);
 
-  if (page < 0 || page >= S->numpags) {
-    S->numillegalrefs++;
-    return ~0U;
-  }
-  
-  if (!S->pgt[page].present)
-    handle_page_fault(S, virtual_addr);
-    
-  frame = S->pgt[page].frame;
-  physical_addr = frame * S->pagsz + offset;
-  
-  reference_page(S, page, op);
-  
-  if (S->detailed) {
-    printf("\t %c %u==P %d(M %d)+ %d\n", op, virtual_addr, page, frame, offset);
+    if (!S->curve) return -1;
   }
 
-  return physical_addr;
+  if (S->exactlru) return 0;  // The stack, in the frames table
+
+  S->data = arena_alloc(S->arena, S->numframes * sizeof(unsigned));
+
+  return S->data ? 0 : -1;
 }
 
-void reference_page(ssystem* S, int page, char op) {
-  // Increment read or write counter
-  if (op == 'R') {
-    S->numrefsread++;
-  } else {
-    S->numrefswrite++;
-  }
-  
-  // If it's a write, mark page as modified
-  if (op == 'W') {
-    S->pgt[page].modified = 1;
-  }
-  
+static void lru_init_tables(ssystem* S) {
+  unsigned* stamp = (unsigned*)S->data;
+  int i;
+
+  if (stamp)
+    for (i = 0; i < S->numframes; i++) stamp[i] = EMPTY;
+}
+
+static void lru_renormalize_timestamps(ssystem* S) {
+  unsigned* stamp = (unsigned*)S->data;
+  int i;
+
+  if (stamp)  // The same ones as the page table
+    for (i = 0; i < S->numframes; i++)
+      if (S->frt[i].page != -1)
+        stamp[i] = PAGE(S, S->frt[i].page, timestamp);
+}
+
+// Functions that simulate the hardware of the MMU
+
+static void lru_reference_page(ssystem* S, int page, char op) {
   // LRU: Store current clock value as timestamp
-  S->pgt[page].timestamp = S->clock;
+  PAGE_SET(S, page, timestamp, STAMP(S));
+  if (S->data) ((unsigned*)S->data)[PAGE(S, page, frame)] = STAMP(S);
   
-  // Increment clock
+  // Increment clock (64 bits; the timestamps are renormalized
+  // before they run out)
   S->clock++;
-  
-  // Check for clock overflow
-  if (S->clock == 0) {
-    fprintf(stderr, "WARNING: Clock overflow! Timestamp values may be unreliable.\n");
+
+  // LRU fault curve: stack distance of this reference
+  if (S->curve) curve_reference(S->curve, page, op);
+
+  // Exact LRU: the frame goes to the top of the stack
+  if (S->exactlru && S->lru != PAGE(S, page, frame)) {
+    lru_stack_unlink(S, PAGE(S, page, frame));
+    lru_stack_push(S, PAGE(S, page, frame));
   }
 }
 
+static void lru_reference_run(ssystem* S, int page, unsigned n) {
+  // The timestamp is the one of the last reference
+  S->clock += n - 1;
+  lru_reference_page(S, page, 'R');
+
+  S->sumresident += (unsigned long long)n * S->numresident;
+}
+
 // Functions that simulate the operating system
 
-void handle_page_fault(ssystem* S, unsigned virtual_addr) {
-  int page, victim, frame, last;
+// The same search, one frame at a time, without the pages pinned
+// by read_ahead (only when the fastest one found one of them)
 
-  S->numpagefaults++;
-  page = virtual_addr / S->pagsz;
-  
-  if (S->detailed) {
-    printf("@ PAGE_FAULT in P %d!\n", page);
-  }
-  
-  if (S->listfree != -1) {
-    // There are free frames
-    last = S->listfree;
-    frame = S->frt[last].next;
-    
-    if (frame == last) {
-      // Then, this is the last one left.
-      S->listfree = -1;
-    } else {
-      // Otherwise, bypass
-      S->frt[last].next = S->frt[frame].next;
+static int unpinned_victim(ssystem* S, const unsigned* stamp) {
+  unsigned min = EMPTY;
+  int i, page, victim = -1;
+
+  for (i = 0; i < S->numframes; i++) {
+    page = S->frt[i].page;
+
+    if (stamp[i] == EMPTY || PINNED(S, page)) continue;
+
+    if (stamp[i] < min || (stamp[i] == min && page < victim)) {
+      min = stamp[i];
+      victim = page;
     }
-    
-    occupy_free_frame(S, frame, page);
-    
-  } else {
-    // There are not free frames
-    victim = choose_page_to_be_replaced(S);
-    replace_page(S, victim, page);
   }
+
+  S->victimsteps += S->numframes;
+  return victim;
 }
 
-int choose_page_to_be_replaced(ssystem* S) {
+static int lru_choose_page_to_be_replaced(ssystem* S, int newpage) {
+  const unsigned* stamp = (const unsigned*)S->data;
   int victim = -1;
   unsigned min_timestamp = ~0U;  // Maximum unsigned value
   int i;
-  
-  // Sequential search for the page with lowest timestamp
-  for (i = 0; i < S->numpags; i++) {
-    if (S->pgt[i].present) {
-      if (S->pgt[i].timestamp < min_timestamp) {
-        min_timestamp = S->pgt[i].timestamp;
-        victim = i;
-      }
+
+  if (S->exactlru) {
+    // The bottom of the stack, in constant time (but the pages
+    // pinned by read_ahead)
+    for (i = S->frt[S->lru].prev; PINNED(S, S->frt[i].page);
+         i = S->frt[i].prev) {
+    }
+
+    victim = S->frt[i].page;
+
+    if (S->detailed) {
+      printf("@ Choosing P %d (bottom of LRU stack) from M %d for "
+             "replacement\n", victim, PAGE(S, victim, frame));
     }
+
+    return victim;
   }
   
+  // Search for the lowest timestamp over the frames, and for the
+  // lowest page that has it
+  min_timestamp = min_stamp(stamp, S->numframes);
+  S->victimsteps += S->numframes;
+
+  if (min_timestamp != EMPTY)
+    for (i = find_stamp(stamp, S->numframes, 0, min_timestamp);
+         i < S->numframes;
+         i = find_stamp(stamp, S->numframes, i + 1, min_timestamp))
+      if (victim == -1 || S->frt[i].page < victim) victim = S->frt[i].page;
+
+  if (PINNED(S, victim)) victim = unpinned_victim(S, stamp);
+  
   if (S->detailed) {
-    printf("@ Choosing P %d (timestamp %u) from M %d for replacement\n",
-           victim, S->pgt[victim].timestamp, S->pgt[victim].frame);
+    printf("@ Choosing P %d (timestamp %llu) from M %d for replacement\n",
+           victim, S->clockbase + PAGE(S, victim, timestamp),
+           PAGE(S, victim, frame));
   }
   
   return victim;
 }
 
-void replace_page(ssystem* S, int victim, int newpage) {
-  int frame;
+static void lru_replace_page(ssystem* S, int victim, int newpage) {
+  int frame = PAGE(S, newpage, frame);
 
-  frame = S->pgt[victim].frame;
+  if (S->data) ((unsigned*)S->data)[frame] = STAMP(S);
 
-  if (S->pgt[victim].modified) {
-    if (S->detailed)
-      printf(
-          "@ Writing modified P%d back (to disc) to "
-          "replace it\n",
-          victim);
-
-    S->numpgwriteback++;
+  // Exact LRU: the new page is the most recently used one
+  if (S->exactlru) {
+    lru_stack_unlink(S, frame);
+    lru_stack_push(S, frame);
   }
-
-  if (S->detailed)
-    printf("@ Replacing victim P%d with P%d in F%d\n", victim, newpage, frame);
-
-  S->pgt[victim].present = 0;
-
-  S->pgt[newpage].present = 1;
-  S->pgt[newpage].frame = frame;
-  S->pgt[newpage].modified = 0;
-
-  S->frt[frame].page = newpage;
 }
 
-void occupy_free_frame(ssystem* S, int frame, int page) {
-  if (S->detailed) printf("@ Storing P%d in F%d\n", page, frame);
+static void lru_occupy_free_frame(ssystem* S, int frame, int page) {
+  if (S->data) ((unsigned*)S->data)[frame] = STAMP(S);
 
-    // Update page table
-    S->pgt[page].present = 1;
-    S->pgt[page].frame = frame;
-    S->pgt[page].modified = 0;
-    S->pgt[page].referenced = 0;
-    S->pgt[page].timestamp = 0;
-  
-    // Update frame table
-    S->frt[frame].page = page;
+  // Exact LRU: the new page is the most recently used one
+  if (S->exactlru) lru_stack_push(S, frame);
 }
 
 // Functions that show results
 
-void print_page_table(ssystem* S) {
+static void lru_print_page_table(ssystem* S) {
   int i;
   
   printf("---------- PAGE TABLE ----------\n");
@@ -200,66 +261,74 @@ void print_page_table(ssystem* S) {
   for (i = 0; i < S->numpags; i++) {
     printf("%4d    ", i);
     
-    if (S->pgt[i].present) {
-      printf("%4d     %4d      %4d      %u\n",
-             S->pgt[i].present,
-             S->pgt[i].frame,
-             S->pgt[i].modified,
-             S->pgt[i].timestamp);
+    if (PAGE(S, i, present)) {
+      printf("%4d     %4d      %4d      %llu\n",
+             PAGE(S, i, present),
+             PAGE(S, i, frame),
+             PAGE(S, i, modified),
+             S->clockbase + PAGE(S, i, timestamp));
     } else {
       printf("%4d        -         -           -\n",
-             S->pgt[i].present);
+             PAGE(S, i, present));
     }
   }
   
   printf("--------------------------------\n");
 }
 
-void print_frames_table(ssystem* S) {
-  int p, f;
-
-  printf("%10s %10s %10s   %s\n", "FRAME", "Page", "Present", "Modified");
-
-  for (f = 0; f < S->numframes; f++) {
-    p = S->frt[f].page;
-
-    if (p == -1)
-      printf("%8d   %8s   %6s     %6s\n", f, "-", "-", "-");
-    else if (S->pgt[p].present)
-      printf("%8d   %8d   %6d     %6d\n", f, p, S->pgt[p].present,
-             S->pgt[p].modified);
-    else
-      printf("%8d   %8d   %6d     %6s   ERROR!\n", f, p, S->pgt[p].present,
-             "-");
-  }
-}
-
-void print_replacement_report(ssystem* S) {
+static void lru_print_replacement_report(ssystem* S) {
   int i;
   unsigned min_timestamp = ~0U;
   unsigned max_timestamp = 0;
   
   printf("--------- REPLACEMENT REPORT ---------\n");
-  printf("LRU replacement policy\n");
-  printf("Current clock value: %u\n", S->clock);
+  printf("LRU replacement policy%s\n",
+         S->exactlru ? " (exact, with LRU stack)" : "");
+  printf("Current clock value: %llu\n", S->clock);
+
+  if (S->exactlru && S->lru != -1) {
+    int frame = S->lru;
+
+    printf("LRU stack (most recently used first):\n");
+
+    do {
+      printf("  M %d -> P %d\n", frame, S->frt[frame].page);
+      frame = S->frt[frame].next;
+    } while (frame != S->lru);
+  }
   
   // Find min and max timestamps of present pages
-  for (i = 0; i < S->numpags; i++) {
-    if (S->pgt[i].present) {
-      if (S->pgt[i].timestamp < min_timestamp) {
-        min_timestamp = S->pgt[i].timestamp;
-      }
-      if (S->pgt[i].timestamp > max_timestamp) {
-        max_timestamp = S->pgt[i].timestamp;
-      }
+  for (i = next_present_page(S, 0); i < S->numpags;
+       i = next_present_page(S, i + 1)) {
+    if (PAGE(S, i, timestamp) < min_timestamp) {
+      min_timestamp = PAGE(S, i, timestamp);
+    }
+    if (PAGE(S, i, timestamp) > max_timestamp) {
+      max_timestamp = PAGE(S, i, timestamp);
     }
   }
   
   if (min_timestamp != ~0U) {
-    printf("Min timestamp in memory: %u\n", min_timestamp);
-    printf("Max timestamp in memory: %u\n", max_timestamp);
+    printf("Min timestamp in memory: %llu\n", S->clockbase + min_timestamp);
+    printf("Max timestamp in memory: %llu\n", S->clockbase + max_timestamp);
   }
+
+  if (S->curve) curve_print(S->curve);
   
   printf("--------------------------------------\n");
-  printf("PAGE FAULTS: --->> %d <<---\n", S->numpagefaults);
+  printf("PAGE FAULTS: --->> %llu <<---\n", S->numpagefaults);
 }
+
+const spolicy policy_lru = {
+    .name = "LRU",
+    .create_tables = lru_create_tables,
+    .init_tables = lru_init_tables,
+    .reference_page = lru_reference_page,
+    .choose_page_to_be_replaced = lru_choose_page_to_be_replaced,
+    .replace_page = lru_replace_page,
+    .occupy_free_frame = lru_occupy_free_frame,
+    .renormalize_timestamps = lru_renormalize_timestamps,
+    .reference_run = lru_reference_run,
+    .print_page_table = lru_print_page_table,
+    .print_replacement_report = lru_print_replacement_report,
+};
@@ -5,18 +5,53 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <unistd.h>
 
 #include "sim_paging.h"
+#include "trace.h"
+#include "sort.h"
 
 // Structure holding data of the parameters passed through
 // the command line (algorithm to be used etc.)
 
 typedef struct
 {
+    const spolicy * policy;
     int pagsz, numframes;
     const char * algorithm, * initialstate;
     int numelem;
     char detailed;
+    char binary;        // 1 = ask gen_trace for a binary trace
+    const char * tracefile;  // Stored trace to replay (or NULL)
+    char exactlru;      // 1 = exact LRU stack instead of LRU(t)
+    int curvemax;       // >0 = LRU fault curve for 1..curvemax
+    const char * configs;    // POLICY:frames[:pagsz],... (or NULL)
+    int numworkers;     // Threads simulating the configurations
+    int round;          // Configurations of -m at a time (0 = all)
+    char inprocess;     // 1 = sort here instead of with gen_trace
+    int window;         // Window/threshold of WS and PFF
+    int readahead;      // Pages read ahead at a fault (0 = none)
+    char adaptive;      // 1 = only for sequential faults
+    int lowwater;       // Frames kept free or clean (0 = no cleaner)
+    int tlbentries;     // TLB (0 = none)
+    int tlbways;
+    char tlbrandom;     // 1 = random replacement in the TLB
+    char layoutkind;    // Layout of the page table (0 = no model)
+    int layoutperlevel; // 2L: entries of a second-level table
+    scost cost;         // Cost model, if costmodel
+    char costmodel;     // >0 = turn the counters into time (the
+                        // number of costs given)
+    char profile;       // 1 = time the stages of the simulation
+    unsigned seriesinterval; // Time series every n refs (0 = none)
+    char seriesbinary;  // 1 = binary samples (-S), 0 = CSV (-s)
+    const char * seriesfile; // Where (-o)
+    char collapse;      // 1 = simulate runs of the same page
+    smixspec mix[MIX_MAX];   // Processes of the workload mix (-M)
+    int nummix;         // How many (0 = no mix)
+    int quantum;        // References of every turn in the mix
+    char localmix;      // 1 = local replacement in the mix
 }
 sparameters;
 
@@ -25,21 +60,190 @@ sparameters;
 
 int parse_command (int, char*[], sparameters*);
 
+// Function that puts the options of the command line in S (the
+// single system, or the model of the workload mix)
+
+void configure_system (ssystem *, const sparameters *);
+
+// Function that builds one system for every configuration in
+// the list of -m (and returns how many, or -1 on error)
+
+int parse_configs (const sparameters *, ssystem **);
+
+// Functions that receive the operations of a sort run inside
+// the process (-i): straight to the MMU, or to the blocks of
+// the systems simulated at once
+
+static void simulate_operation (void * arg, char op, unsigned pos)
+{
+    if (op!='C')                       // If R/W,
+        sim_mmu ((ssystem*)arg, pos, op);  // simulate mem. access
+}
+
+typedef struct
+{
+    smulti * M;
+    sref * block;       // Block being filled
+    int n;              // Operations in it
+}
+sfeed;
+
+static void feed_operation (void * arg, char op, unsigned pos)
+{
+    sfeed * f = (sfeed*) arg;
+
+    if (op=='C')        // Nothing to simulate
+        return;
+
+    f->block[f->n].op = op;
+    f->block[f->n].elem = pos;
+
+    if (++f->n == MULTI_BLOCK)
+    {
+        multi_submit (f->M, f->n);
+        f->block = multi_block (f->M);
+        f->n = 0;
+    }
+}
+
+// Operations of a sort run inside the process, gathered into
+// blocks to be simulated in runs (-i with -R)
+
+typedef struct
+{
+    ssystem * S;
+    sref refs[TRACE_BLOCK];
+    spagerun runs[TRACE_BLOCK];
+    int n;              // Operations in refs
+}
+sbatch;
+
+static void flush_batch (sbatch * b)
+{
+    simulate_runs (b->S, b->runs,
+                   collapse_runs(b->refs,b->n,b->S->pagsz,b->runs));
+    b->n = 0;
+}
+
+static void batch_operation (void * arg, char op, unsigned pos)
+{
+    sbatch * b = (sbatch*) arg;
+
+    if (op=='C')        // Nothing to simulate
+        return;
+
+    b->refs[b->n].op = op;
+    b->refs[b->n].elem = pos;
+
+    if (++b->n == TRACE_BLOCK)
+        flush_batch (b);
+}
+
+// Whole trace in memory, for the policies that need to know the
+// future (OPT): only the R/W operations, one after the other
+
+typedef struct
+{
+    sref * refs;
+    unsigned n, max;    // Operations in refs and room for them
+    char error;         // 1 = not enough dynamic memory, 2 = more
+                        // than the 32 bits of OPT's positions
+}
+srecord;
+
+static void record_operation (void * arg, char op, unsigned pos)
+{
+    srecord * r = (srecord*) arg;
+    sref * bigger;
+
+    if (op=='C' || r->error)
+        return;
+
+    if (r->n==r->max && r->max>UINT_MAX/2)
+    {
+        r->error = 2;
+        return;
+    }
+
+    if (r->n==r->max)
+    {
+        bigger = (sref*) realloc (r->refs,
+                                  (r->max ? 2*r->max : 65536)*sizeof(sref));
+
+        if (!bigger)
+        {
+            r->error = 1;
+            return;
+        }
+
+        r->refs = bigger;
+        r->max = r->max ? 2*r->max : 65536;
+    }
+
+    r->refs[r->n].op = op;
+    r->refs[r->n].elem = pos;
+    r->n ++;
+}
+
+// Function that reads the trace again from the beginning, for
+// the next round of configurations (-k)
+
+static int rewind_trace (strace * T, const sparameters * p,
+                         const char * command)
+{
+    if (trace_close(T)<0)
+        return -1;
+
+    return p->tracefile ? trace_map (T, p->tracefile)
+                        : trace_open (T, command);
+}
+
+// Function that reads the next block of the trace, timed if
+// there is a profile
+
+static int read_block (strace * T, sref * refs, sprofile * prof)
+{
+    unsigned long long t0;
+    int n;
+
+    if (!prof)
+        return trace_read (T, refs, TRACE_BLOCK);
+
+    t0 = PROF_TICKS ();
+    n = trace_read (T, refs, TRACE_BLOCK);
+    PROF_ADD (prof, PROF_DECODE, t0);
+
+    return n;
+}
+
 // Main function
 
 int main (int argc, char * argv[])
 {
     sparameters P;      // Parameters received in the command line
     char command[100];  // Command for executing gen_trace
-    FILE * pipe;        // Communication channel with gen_trace
+    strace T;           // Trace coming from gen_trace
+    sref refs[TRACE_BLOCK];  // Block of operations of the trace
+    spagerun runs[TRACE_BLOCK];   // The same block, in runs (-R)
+    sbatch * batch;     // Operations of the sort, in blocks (-i -R)
     int ok;             // Flag
-    char op;            // Elementary operation ('R'ead, 'W'ri..)
-    unsigned u;         // Number of the read/written element
-    unsigned numpags;   // Total number of pages
-    unsigned totelem;   // Total num. of elements (double in MER)
+    int n, i;           // Operations in the block and index
+    unsigned totalsz;   // Total # of elements (double in MER)
     ssystem S;          // State of the whole simulated system
+    ssystem * systems;  // Systems simulated at once (-m)
+    int numsystems = 0; // Number of them
+    function_sort * psort;            // Sort run in process (-i)
+    function_prepare_data * pprepare;
+    sfeed feed;         // Blocks for the systems (-i with -m)
+    srecord future;     // Whole trace, if some policy needs it
+    char needfuture;    // 1 = so it does
+    sarena * arenas;    // Tables of every thread (-m), one round
+    int numarenas;      // after another (-k)
+    ssystem * round;    // Systems of this round
+    int first, count;   // First of them and how many
 
     memset (&S, 0, sizeof(S));  // Reset system
+    memset (&future, 0, sizeof(future));
 
     if (parse_command(argc,argv,&P)<0)  // Put parameters in P
         return -1;
@@ -49,35 +253,286 @@ int main (int argc, char * argv[])
             P.algorithm, P.initialstate, P.numelem,
             P.detailed?'D':'N');
 
-    // Prepare command for invoking gen_trace
-    // (sprintf "prints" in a string)
-    sprintf (command, "./gen_trace %s %s %u",
-                      P.algorithm, P.initialstate, P.numelem);
+    if (P.configs)
+    {
+        numsystems = parse_configs (&P, &systems);
+
+        if (numsystems<0)
+            return -1;
+
+        printf ("# Configurations:  %s (%d, %d threads)\n",
+                P.configs, numsystems,
+                P.numworkers<numsystems ? P.numworkers : numsystems);
+
+        if (P.round)
+            printf ("# Rounds:  %d configurations at a time\n", P.round);
+    }
+    else
+        printf ("# Replacement policy:  %s\n", P.policy->name);
+
+    needfuture = !P.configs && P.policy->know_future;
+
+    for (i=0; P.configs && i<numsystems; i++)
+        if (systems[i].policy->know_future)
+            needfuture = 1;
+
+    if (P.configs || P.policy->variable)
+        printf ("# Window of WS/PFF:  %d references\n", P.window);
 
-    printf ("# Executing command:  %s\n", command);
+    if (P.readahead)
+        printf ("# Readahead:  %s%d pages\n",
+                P.adaptive ? "adaptive, up to " : "", P.readahead);
 
-    // Invoke gen_trace and open a pipe to read
-    // its standard output ("r" stands for read)
-    pipe = popen (command, "r");
+    if (P.lowwater)
+        printf ("# Page cleaner:  %d frames free or clean\n", P.lowwater);
 
-    if (!pipe)
+    if (P.tlbentries)
+        printf ("# TLB:  %d entries, %d-way, %s replacement\n",
+                P.tlbentries, P.tlbways, P.tlbrandom ? "random" : "LRU");
+
+    if (P.layoutkind==LAYOUT_2L)
+        printf ("# Page table layout:  two-level, %d entries per "
+                "second-level table\n", P.layoutperlevel);
+    else if (P.layoutkind)
+        printf ("# Page table layout:  %s\n",
+                P.layoutkind==LAYOUT_INV ? "inverted" : "flat");
+
+    if (P.seriesinterval)
+        printf ("# Time series:  every %u references, %s in %s%s\n",
+                P.seriesinterval, P.seriesbinary ? "binary" : "CSV",
+                P.seriesfile, P.configs ? ".n (configuration n)" : "");
+
+    if (P.costmodel)
     {
-        perror ("ERROR while starting gen_trace");
+        printf ("# Costs (ns):  memory %g, fault %g, write back %g",
+                P.cost.memtime, P.cost.faulttime, P.cost.writebacktime);
+
+        if (P.costmodel==4)
+            printf (", TLB %g (hit ratio of -T)", P.cost.tlbtime);
+        else if (P.cost.tlbtime)
+            printf (", TLB %g (hit ratio %g)",
+                    P.cost.tlbtime, P.cost.tlbhitratio);
+
+        printf ("\n");
+    }
+
+    if (P.nummix)
+    {
+        if (needfuture)
+        {
+            fprintf (stderr, "ERROR: OPT cannot know the future of a "
+                             "workload mix (-M)\n");
+            return -1;
+        }
+
+        configure_system (&S, &P);
+
+        return simulate_mix (&S, P.mix, P.nummix, P.quantum, P.localmix,
+                             P.binary) == 0 ? 0 : -1;
+    }
+
+    if (P.collapse && needfuture)
+    {
+        fprintf (stderr, "ERROR: OPT needs every reference, not "
+                         "runs of them (-R)\n");
         return -1;
     }
 
-    // Read total # of elements to be sorted
-    ok = fscanf (pipe," T %u", &totelem) == 1;
+    if (P.readahead && needfuture)
+    {
+        fprintf (stderr, "ERROR: OPT does not know about the pages "
+                         "read ahead (-r)\n");
+        return -1;
+    }
 
-    if (ok)
+    psort = find_sort (P.algorithm);
+    pprepare = find_prepare (P.initialstate);
+
+    if (P.inprocess)
+    {
+        printf ("# Sorting in process:  %s %s %u\n",
+                P.algorithm, P.initialstate, P.numelem);
+
+        totalsz = sort_total_size (psort, P.numelem);
+        ok = 1;
+    }
+    else
     {
-        // Calculate total number of pages
-        numpags = (totelem+P.pagsz-1) / P.pagsz; 
+        if (P.tracefile)
+        {
+            printf ("# Reading trace file:  %s\n", P.tracefile);
+
+            // Map the stored trace and read total # of elements
+            ok = trace_map (&T, P.tracefile) == 0;
+        }
+        else
+        {
+            // Prepare command for invoking gen_trace
+            // (sprintf "prints" in a string)
+            sprintf (command, "./gen_trace %s%s %s %u",
+                              P.binary ? "-b " : "",
+                              P.algorithm, P.initialstate, P.numelem);
+
+            printf ("# Executing command:  %s\n", command);
+
+            // Invoke gen_trace and read total # of elements
+            // to be sorted
+            ok = trace_open (&T, command) == 0;
+        }
+
+        totalsz = T.totalsz;
+    }
+
+    if (ok && needfuture)
+    {
+        // Read the whole trace before simulating anything
+        if (P.inprocess)
+            ok = sort_in_process (psort, pprepare, P.numelem,
+                                  record_operation, &future) == 0;
+
+        while (ok && !P.inprocess &&
+               (n=trace_read(&T,refs,TRACE_BLOCK)) != 0)
+        {
+            if (n<0)
+            {
+                ok = 0;
+                break;
+            }
 
-        S.pgt = (spage*) malloc (numpags*sizeof(spage));
-        S.frt = (sframe*) malloc (P.numframes*sizeof(sframe));
+            for (i=0; i<n; i++)
+                record_operation (&future, refs[i].op, refs[i].elem);
+        }
 
-        if (!S.pgt || !S.frt)
+        if (future.error==2)
+        {
+            fprintf (stderr, "ERROR: the trace is too long to be "
+                             "kept in memory (OPT)\n");
+            ok = 0;
+        }
+        else if (future.error)
+        {
+            fprintf (stderr, "ERROR: not enough dynamic memory "
+                             "for the whole trace\n");
+            ok = 0;
+        }
+        else if (ok)
+            printf ("# Trace in memory:  %u references\n", future.n);
+    }
+
+    if (ok && P.configs)
+    {
+        // Every system has its own tables, for the same trace, from
+        // the arena of the thread that simulates it (system i of a
+        // round belongs to thread i % numarenas, see sim_pag_multi.c),
+        // although this thread creates and frees all of them; from a
+        // round to the next, the arenas start again, so the tables of
+        // a round take the place of the previous ones
+        numarenas = P.numworkers<numsystems ? P.numworkers : numsystems;
+        arenas = (sarena*) calloc (numarenas, sizeof(sarena));
+
+        if (!arenas)
+        {
+            fprintf (stderr, "ERROR: not enough dynamic memory\n");
+            ok = 0;
+        }
+
+        for (first=0; ok && first<numsystems; first+=count)
+        {
+            round = systems+first;
+            count = P.round && P.round<numsystems-first ? P.round
+                                                          : numsystems-first;
+
+            if (first>0)        // The trace again, for this round
+            {
+                for (i=0; i<numarenas; i++)
+                    arena_reset (&arenas[i]);
+
+                if (!P.inprocess && !needfuture &&
+                    rewind_trace(&T,&P,command)<0)
+                {
+                    ok = 0;
+                    break;
+                }
+            }
+
+            for (i=0; ok && i<count; i++)
+            {
+                round[i].arena = &arenas[i%numarenas];
+
+                if (create_tables(&round[i],totalsz)<0 ||
+                    (round[i].policy->know_future &&
+                     round[i].policy->know_future(&round[i],future.refs,
+                                                  future.n)<0))
+                {
+                    fprintf (stderr,
+                             "ERROR: not enough "
+                                    "dynamic memory\n");
+                    ok = 0;
+                }
+            }
+
+            if (ok && needfuture)
+                ok = simulate_recorded (future.refs, future.n, round,
+                                        count, P.numworkers) == 0;
+            else if (ok && P.inprocess)
+            {
+                feed.M = multi_start (round, count, P.numworkers);
+
+                if (!feed.M)
+                    ok = 0;
+                else
+                {
+                    feed.block = multi_block (feed.M);
+                    feed.n = 0;
+
+                    ok = sort_in_process (psort, pprepare, P.numelem,
+                                          feed_operation, &feed) == 0;
+
+                    if (feed.n>0)   // The last block, if not full
+                        multi_submit (feed.M, feed.n);
+                    multi_finish (feed.M);
+                }
+            }
+            else if (ok && simulate_systems(&T,round,count,
+                                            P.numworkers)<0)
+                ok = 0;
+
+            for (i=0; i<count; i++)     // The last samples
+                ok = series_close(&round[i])==0 && ok;
+
+            if (ok)
+            {
+                if (first==0)
+                    print_summary_header (&systems[0]);
+
+                for (i=0; i<count; i++)
+                    print_summary (&round[i]);
+            }
+
+            for (i=0; i<count; i++)
+                free_tables (&round[i]);
+        }
+
+        if (!P.inprocess && T.buf)
+            ok = trace_close(&T)==0 && ok;
+
+        for (i=0; arenas && i<numarenas; i++)
+            arena_free (&arenas[i]);
+
+        free (arenas);
+        free (systems);
+        free (future.refs);
+
+        return ok ? 0 : -1;
+    }
+
+    if (ok)
+    {
+        configure_system (&S, &P);
+
+        if (create_tables(&S,totalsz)<0 ||
+            (S.policy->know_future &&
+             S.policy->know_future(&S,future.refs,future.n)<0))
         {
             fprintf (stderr,
                      "ERROR: not enough "
@@ -86,65 +541,241 @@ int main (int argc, char * argv[])
         }
     }
 
-    if (ok)
+    if (ok && needfuture)
     {
-        S.pagsz = P.pagsz;
-        S.numpags = numpags;
-        S.numframes = P.numframes;
-        S.detailed = P.detailed;
+        for (i=0; i<future.n; i++)
+            sim_mmu (&S, future.refs[i].elem, future.refs[i].op);
+    }
+    else if (ok && P.inprocess && P.collapse)
+    {
+        batch = (sbatch*) malloc (sizeof(sbatch));
+
+        if (!batch)
+        {
+            fprintf (stderr, "ERROR: not enough dynamic memory\n");
+            ok = 0;
+        }
+        else
+        {
+            batch->S = &S;
+            batch->n = 0;
+
+            ok = sort_in_process (psort, pprepare, P.numelem,
+                                  batch_operation, batch) == 0;
 
-        init_tables (&S);
+            flush_batch (batch);        // The last block
+            free (batch);
+        }
     }
+    else if (ok && P.inprocess)
+        ok = sort_in_process (psort, pprepare, P.numelem,
+                              simulate_operation, &S) == 0;
 
-    while (ok)
+    while (ok && !P.inprocess && !needfuture &&
+           (n=read_block(&T,refs,S.prof)) != 0)
     {
-        // Ignore spaces and read one character
-        if (fscanf(pipe," %c",&op)!=1)
+        if (n<0)
         {
             ok = 0;
             break;
         }
 
-        if (op=='R' || op=='W')              // If R/W,
-        {                                    // take element
-            if (fscanf(pipe,"%u",&u)!=1)     // number and
-                ok = 0;                      // annotate
-            else
-                sim_mmu (&S, u, op);  // Simulate memory access
+        if (S.collapse)
+        {
+            simulate_runs (&S, runs, collapse_runs(refs,n,S.pagsz,runs));
+            continue;
         }
-        else if (op=='S')        // 'S'orted -> end
-            break;               // 'C'omparison -> go on
-        else if (op!='C')        // 'O'ut of order (or
-            ok = 0;              // something else) -> error
-    }
+
+        for (i=0; i<n; i++)
+            if (refs[i].op!='C')                    // If R/W,
+                sim_mmu (&S, refs[i].elem, refs[i].op);  // simulate
+    }                                               // mem. access
+
+    ok = series_close(&S)==0 && ok;     // The last sample
 
     if (ok)
         print_report (&S);
 
     // Wait until gen_trace ends and close
-    if (pclose(pipe)==-1)
+    if (!P.inprocess && trace_close(&T)<0)
         ok = 0;
 
-    // Free dynamic memory
-    free (S.pgt);
-    free (S.frt);
+    // Free dynamic memory (with the systems of -m, if the trace
+    // failed before they were simulated)
+    free_tables (&S);
+    free (future.refs);
+
+    if (P.configs)
+        free (systems);
 
     return ok ? 0 : -1;
 }
 
+// Function that puts the options of the command line in S
+
+void configure_system (ssystem * S, const sparameters * p)
+{
+    S->policy = p->policy;
+    S->pagsz = p->pagsz;
+    S->numframes = p->numframes;
+    S->detailed = p->detailed;
+    S->exactlru = p->exactlru;
+    S->curvemax = p->curvemax;
+    S->window = p->window;
+    S->readahead = p->readahead;
+    S->adaptive = p->adaptive;
+    S->lowwater = p->lowwater;
+    S->cost = p->costmodel ? &p->cost : NULL;
+    S->tlbentries = p->tlbentries;
+    S->tlbways = p->tlbways;
+    S->tlbrandom = p->tlbrandom;
+    S->layoutkind = p->layoutkind;
+    S->layoutperlevel = p->layoutperlevel;
+    S->profile = p->profile;
+    S->seriesinterval = p->seriesinterval;
+    S->seriesbinary = p->seriesbinary;
+    S->seriesfile = p->seriesfile;
+    S->collapse = p->collapse;
+}
+
 // Function that shows the results
 
+static double walk_accesses (slayout * L)
+{
+    return L->walks ? L->accesses / (double)L->walks : 0;
+}
+
+static double mean_resident (ssystem * S)
+{
+    unsigned long long refs = S->numrefsread + S->numrefswrite;
+
+    return refs ? S->sumresident / (double)refs : 0;
+}
+
+// Function that shows the profile: every stage includes the ones
+// it calls (sim_mmu includes the faults, and they include the
+// searches of victims)
+
+static double prof_ms (const sprofile * P, int stage, double perns)
+{
+    return P->ticks[stage] / perns / 1e6;
+}
+
+static void print_profile (ssystem * S)
+{
+    static const char * names[PROF_STAGES] =
+        { "read trace", "sim_mmu", "page faults", "victim search" };
+    const sprofile * P = S->prof;
+    double perns = prof_ticks_per_ns (P);
+    unsigned long long searches = P->calls[PROF_VICTIM];
+    char range[32];
+    int i;
+
+    sprintf (range, "Profile (%.2f ticks/ns):", perns);
+    printf ("%-24s %12s %10s %10s\n", range, "calls", "ms", "ns/call");
+
+    for (i=0; i<PROF_STAGES; i++)
+        if (P->calls[i])
+            printf ("  %-22s %12llu %10.3f %10.1f\n", names[i],
+                    P->calls[i], prof_ms(P,i,perns),
+                    P->ticks[i] / perns / P->calls[i]);
+
+    if (!searches)
+        return;
+
+    printf ("Victim search steps:      %.2f each\n",
+            S->victimsteps / (double)searches);
+
+    for (i=0; i<PROF_BUCKETS; i++)
+    {
+        if (!P->hist[i])
+            continue;
+
+        if (i==0)
+            sprintf (range, "1");
+        else if (i==PROF_BUCKETS-1)
+            sprintf (range, "%llu and more", 1ULL<<i);
+        else
+            sprintf (range, "%llu-%llu", 1ULL<<i, (2ULL<<i)-1);
+
+        printf ("  %-22s %12llu (%.2f%%)\n", range, P->hist[i],
+                100.0*P->hist[i]/searches);
+    }
+}
+
 void print_report (ssystem * S)
 {
     printf ("\n---------- GENERAL REPORT ----------\n\n");
 
-    printf ("Read references:          %d\n", S->numrefsread);
-    printf ("Write references:         %d\n", S->numrefswrite);
-    printf ("Page faults:              %d\n", S->numpagefaults);
-    printf ("Page dumps to disc:       %d\n", S->numpgwriteback);
+    printf ("Read references:          %llu\n", S->numrefsread);
+    printf ("Write references:         %llu\n", S->numrefswrite);
+    printf ("Page faults:              %llu\n", S->numpagefaults);
+    printf ("Page dumps to disc:       %llu\n", S->numpgwriteback);
+
+    if (S->policy->variable)
+    {
+        printf ("Mean resident set:        %.2f frames\n",
+                mean_resident(S));
+        printf ("Peak resident set:        %d frames\n",
+                S->maxresident);
+    }
+
+    if (S->readahead)
+    {
+        printf ("Pages read ahead:         %llu\n", S->numprefetched);
+        printf ("  referenced afterwards:  %llu\n", S->numprefetchhits);
+        printf ("  evicted unreferenced:   %llu\n",
+                S->numprefetchuseless);
+        printf ("  never referenced:       %d (still loaded)\n",
+                prefetched_resident(S));
+    }
+
+    if (S->lowwater)
+    {
+        printf ("Pages cleaned in advance: %llu\n", S->numcleaned);
+        printf ("  modified again:         %llu\n", S->numcleanwasted);
+        printf ("Faults served clean:      %llu\n",
+                S->numpagefaults - S->numfaultswait);
+        printf ("Faults waiting for disc:  %llu (dirty victim)\n",
+                S->numfaultswait);
+    }
+
+    if (S->tlb)
+    {
+        printf ("TLB hits:                 %llu (%.2f%%)\n", S->tlb->hits,
+                S->tlb->hits+S->tlb->misses ?
+                100.0*S->tlb->hits/(S->tlb->hits+S->tlb->misses) : 0);
+        printf ("TLB misses:               %llu\n", S->tlb->misses);
+        printf ("TLB invalidations:        %llu\n", S->tlb->invalidations);
+    }
+
+    if (S->layout)
+    {
+        printf ("Page table (%s):  %zu bytes, peak %zu "
+                "(flat: %zu)\n", layout_name(S->layout),
+                S->layout->bytes, S->layout->peakbytes,
+                (size_t)S->numpags*LAYOUT_PTE_BYTES);
+        printf ("Page table walks:         %llu, %.2f accesses each, "
+                "%.2f per reference\n", S->layout->walks,
+                walk_accesses(S->layout),
+                S->numrefsread+S->numrefswrite ?
+                S->layout->accesses /
+                (double)(S->numrefsread+S->numrefswrite) : 0);
+    }
+
+    if (S->cost)
+    {
+        printf ("Effective access time:    %.2f ns\n",
+                effective_access_time(S));
+        printf ("Simulated time:           %.3f ms\n",
+                simulated_time(S)/1e6);
+    }
+
+    if (S->prof)
+        print_profile (S);
 
     if (S->numillegalrefs)
-        printf ("\nWARNING: %d REFERENCES OUT OF RANGE\n",
+        printf ("\nWARNING: %llu REFERENCES OUT OF RANGE\n",
                 S->numillegalrefs);
                          
     printf ("\n---------- PAGES TABLE ---------\n\n");
@@ -160,27 +791,494 @@ void print_report (ssystem * S)
     print_replacement_report (S);
 
     printf ("\n-------------------------------------\n\n");
-    printf ("PAGE FAULTS: --->> %d <<---\n\n",
+    printf ("PAGE FAULTS: --->> %llu <<---\n\n",
             S->numpagefaults);
 }
 
+// Functions that show the results of several systems, one row
+// for each one
+
+void print_summary_header (ssystem * S)
+{
+    printf ("\n%-10s %6s %7s %12s %12s %12s %12s %9s %9s %8s",
+            "# POLICY", "PAGSZ", "FRAMES", "READS", "WRITES",
+            "FAULTS", "WRITEBACKS", "ILLEGAL", "MEANRES", "PEAKRES");
+
+    if (S->readahead)
+        printf (" %12s %12s %12s", "READAHEAD", "RAHITS", "RAUSELESS");
+
+    if (S->lowwater)
+        printf (" %12s %12s %12s", "CLEANED", "CLEANWASTED", "FAULTSWAIT");
+
+    if (S->tlbentries)
+        printf (" %12s %12s", "TLBHITS", "TLBMISSES");
+
+    if (S->layoutkind)
+        printf (" %12s %8s", "PTPEAKBYTES", "PTACC");
+
+    if (S->cost)
+        printf (" %12s %14s", "EAT_NS", "TIME_MS");
+
+    if (S->profile)
+        printf (" %10s %10s %10s %8s", "MMU_MS", "FAULT_MS", "VICTIM_MS",
+                "STEPS");
+
+    printf ("\n");
+}
+
+void print_summary (ssystem * S)
+{
+    unsigned long long searches;
+    double perns;
+
+    printf ("%-10s %6d %7d %12llu %12llu %12llu %12llu %9llu %9.2f %8d",
+            S->policy->name, S->pagsz, S->numframes,
+            S->numrefsread, S->numrefswrite, S->numpagefaults,
+            S->numpgwriteback, S->numillegalrefs,
+            mean_resident(S), S->maxresident);
+
+    if (S->readahead)
+        printf (" %12llu %12llu %12llu", S->numprefetched,
+                S->numprefetchhits,     // Useless: also the ones
+                S->numprefetchuseless + prefetched_resident(S));  // left
+
+    if (S->lowwater)
+        printf (" %12llu %12llu %12llu", S->numcleaned, S->numcleanwasted,
+                S->numfaultswait);
+
+    if (S->tlb)
+        printf (" %12llu %12llu", S->tlb->hits, S->tlb->misses);
+
+    if (S->layout)
+        printf (" %12zu %8.2f", S->layout->peakbytes,
+                walk_accesses(S->layout));
+
+    if (S->cost)
+        printf (" %12.2f %14.3f", effective_access_time(S),
+                simulated_time(S)/1e6);
+
+    if (S->prof)
+    {
+        perns = prof_ticks_per_ns (S->prof);
+        searches = S->prof->calls[PROF_VICTIM];
+
+        printf (" %10.3f %10.3f %10.3f %8.2f",
+                prof_ms(S->prof,PROF_MMU,perns),
+                prof_ms(S->prof,PROF_FAULT,perns),
+                prof_ms(S->prof,PROF_VICTIM,perns),
+                searches ? S->victimsteps / (double)searches : 0);
+    }
+
+    printf ("\n");
+}
+
+// Function that builds one system for every configuration in
+// the list of -m: POLICY:numframes[:pagesize],... (the page size
+// by default is the one in the command line)
+
+int parse_configs (const sparameters * p, ssystem ** psystems)
+{
+    char name[32];
+    const char * c;
+    ssystem * systems;
+    sparameters q;
+    int n, i, len, frames, pagsz, used;
+
+    for (n=1, c=p->configs; *c; c++)  // Count them
+        if (*c==',')
+            n++;
+
+    systems = (ssystem*) calloc (n, sizeof(ssystem));
+
+    if (!systems)
+    {
+        fprintf (stderr, "ERROR: not enough dynamic memory\n");
+        return -1;
+    }
+
+    for (i=0, c=p->configs; i<n; i++, c+=used+(c[used]==','))
+    {
+        len = strcspn (c, ":,");
+        pagsz = p->pagsz;
+
+        if (len>=sizeof(name) || c[len]!=':')
+            break;
+
+        memcpy (name, c, len);
+        name[len] = '\0';
+        used = len+1;
+
+        if (sscanf(c+used,"%d%n",&frames,&len)!=1 || frames<1)
+            break;
+
+        used += len;
+
+        if (c[used]==':')
+        {
+            used ++;
+
+            if (sscanf(c+used,"%d%n",&pagsz,&len)!=1 || pagsz<1)
+                break;
+
+            used += len;
+        }
+
+        if (c[used]!=',' && c[used]!='\0')
+            break;
+
+        q = *p;  // The command line, with the fields of this one
+        q.policy = find_policy (name);
+        q.numframes = frames;
+        q.pagsz = pagsz;
+
+        if (!q.policy)
+            break;
+
+        configure_system (&systems[i], &q);
+
+        if (p->costmodel)                  // The cost model of p,
+            systems[i].cost = &p->cost;    // that outlives q
+
+        systems[i].seriesindex = i+1;
+    }
+
+    if (i<n)
+    {
+        fprintf (stderr,
+                 "ERROR: wrong configuration %d in -m "
+                        "(POLICY:numframes[:pagesize],...)\n", i+1);
+        free (systems);
+        return -1;
+    }
+
+    *psystems = systems;
+    return n;
+}
+
 // Function that parses the parameters received through the
 // command line:
 
 #define VALID_ALGORITHMS "BUB/INS/SEL/HEA/COM/MER/QUI/QRP"
 #define VALID_INIT_ORD "ASC/DES/RAN"
+#define DEFAULT_POLICY "LRU"
+#define DEFAULT_WINDOW 1000
+#define DEFAULT_PERLEVEL 512
+#define DEFAULT_QUANTUM 10000
+
+// The policy by default comes from the name of the program:
+// sim_pag_fifo -> FIFO, and so on (sim_pag -> DEFAULT_POLICY)
+
+static const spolicy * policy_from_name (const char * prog)
+{
+    char name[32];
+    const char * base;
+    int i;
+
+    base = strrchr (prog, '/');
+    base = base ? base+1 : prog;
+
+    if (strncmp(base,"sim_pag_",8) || strlen(base+8)>=sizeof(name))
+        return find_policy (DEFAULT_POLICY);
+
+    for (i=0; base[8+i]; i++)
+        name[i] = toupper ((unsigned char)base[8+i]);
+
+    name[i] = '\0';
+
+    return find_policy(name) ? find_policy(name)
+                             : find_policy(DEFAULT_POLICY);
+}
+
+// The processes of the workload mix: alg:initord:numelem,...
+
+static int parse_mix (const char * list, sparameters * p)
+{
+    smixspec * m;
+    int used;
+
+    for (p->nummix=0; *list; list+=used+(list[used]==','))
+    {
+        if (p->nummix==MIX_MAX)
+            return -1;
+
+        m = &p->mix[p->nummix++];
+
+        if (sscanf(list,"%3[A-Z]:%3[A-Z]:%d%n",m->algorithm,
+                   m->initialstate,&m->numelem,&used)!=3 ||
+            (list[used]!=',' && list[used]!='\0') ||
+            strlen(m->algorithm)!=3 ||
+            !strstr(VALID_ALGORITHMS,m->algorithm) ||
+            strlen(m->initialstate)!=3 ||
+            !strstr(VALID_INIT_ORD,m->initialstate) ||
+            m->numelem<2)
+            return -1;
+    }
+
+    return p->nummix ? 0 : -1;
+}
 
 int parse_command (int argc, char * argv[], sparameters * p)
 {
-    int ok;
+    const char * prog = argv[0];
+    char policy[4];
+    int ok, opt, i, n;
 
     // Default parameters
+    p->policy = policy_from_name (prog);
     p->pagsz = 16;
     p->numframes = 32;
     p->algorithm = "MER";
     p->initialstate = "RAN";
     p->numelem = 1000;
     p->detailed = 0;
+    p->binary = 0;
+    p->tracefile = NULL;
+    p->exactlru = 0;
+    p->curvemax = 0;
+    p->configs = NULL;
+    p->inprocess = 0;
+    p->window = DEFAULT_WINDOW;
+    p->readahead = 0;
+    p->adaptive = 0;
+    p->lowwater = 0;
+    p->costmodel = 0;
+    p->tlbentries = 0;
+    p->tlbways = 0;
+    p->tlbrandom = 0;
+    p->layoutkind = 0;
+    p->layoutperlevel = DEFAULT_PERLEVEL;
+    p->seriesinterval = 0;
+    p->seriesbinary = 0;
+    p->seriesfile = NULL;
+    p->collapse = 0;
+    p->nummix = 0;
+    p->quantum = DEFAULT_QUANTUM;
+    p->localmix = 0;
+    p->round = 0;
+    p->numworkers = sysconf (_SC_NPROCESSORS_ONLN);
+
+    if (p->numworkers<1)
+        p->numworkers = 1;
+
+    // Options go before the positional parameters
+
+    ok = 1;
+
+    while ((opt=getopt(argc,argv,"abc:de:f:ij:k:l:L:m:M:o:p:Pq:r:Rs:S:t:T:x")) != -1)
+        switch (opt)
+        {
+            case 'b':
+                p->binary = 1;
+                break;
+
+            case 'f':
+                p->tracefile = optarg;
+                break;
+
+            case 'i':
+                p->inprocess = 1;
+                break;
+
+            case 'x':
+                p->exactlru = 1;
+                break;
+
+            case 'a':
+                p->adaptive = 1;
+                break;
+
+            case 'P':
+                p->profile = 1;
+                break;
+
+            case 'R':
+                p->collapse = 1;
+                break;
+
+            case 'd':
+                p->localmix = 1;
+                break;
+
+            case 'M':
+                if (parse_mix(optarg,p)<0)
+                {
+                    fprintf (stderr,
+                             "\n    ERROR: wrong workload mix "
+                                          "(alg:initord:numelem,...; at "
+                                          "most %d)", MIX_MAX);
+                    ok = 0;
+                }
+                break;
+
+            case 'q':
+                if (sscanf(optarg,"%d",&p->quantum)!=1 ||
+                    p->quantum<1)
+                {
+                    fprintf (stderr,
+                             "\n    ERROR: wrong quantum");
+                    ok = 0;
+                }
+                break;
+
+            case 'p':
+                p->policy = find_policy (optarg);
+
+                if (!p->policy)
+                {
+                    fprintf (stderr,
+                             "\n    ERROR: wrong replacement policy");
+                    ok = 0;
+                }
+                break;
+
+            case 'm':
+                p->configs = optarg;
+                break;
+
+            case 's':
+            case 'S':
+                if (sscanf(optarg,"%u",&p->seriesinterval)!=1 ||
+                    p->seriesinterval<1)
+                {
+                    fprintf (stderr,
+                             "\n    ERROR: wrong interval of the "
+                                          "time series");
+                    ok = 0;
+                }
+
+                p->seriesbinary = opt=='S';
+                break;
+
+            case 'o':
+                p->seriesfile = optarg;
+                break;
+
+            case 'j':
+                if (sscanf(optarg,"%d",&p->numworkers)!=1 ||
+                    p->numworkers<1)
+                {
+                    fprintf (stderr,
+                             "\n    ERROR: wrong number of threads");
+                    ok = 0;
+                }
+                break;
+
+            case 'k':
+                if (sscanf(optarg,"%d",&p->round)!=1 ||
+                    p->round<1)
+                {
+                    fprintf (stderr,
+                             "\n    ERROR: wrong configurations per "
+                                          "round");
+                    ok = 0;
+                }
+                break;
+
+            case 't':
+                if (sscanf(optarg,"%d",&p->window)!=1 ||
+                    p->window<1)
+                {
+                    fprintf (stderr,
+                             "\n    ERROR: wrong window");
+                    ok = 0;
+                }
+                break;
+
+            case 'r':
+                if (sscanf(optarg,"%d",&p->readahead)!=1 ||
+                    p->readahead<1)
+                {
+                    fprintf (stderr,
+                             "\n    ERROR: wrong readahead");
+                    ok = 0;
+                }
+                break;
+
+            case 'T':
+                n = sscanf (optarg, "%d:%d:%3s", &p->tlbentries,
+                            &p->tlbways, policy);
+
+                if (n==1)              // Fully associative
+                    p->tlbways = p->tlbentries;
+
+                p->tlbrandom = n==3 && !strcmp(policy,"RAN");
+
+                if (n<1 || p->tlbentries<1 || p->tlbways<1 ||
+                    p->tlbentries%p->tlbways ||
+                    (n==3 && !p->tlbrandom && strcmp(policy,"LRU")))
+                {
+                    fprintf (stderr,
+                             "\n    ERROR: wrong TLB "
+                                          "(entries[:ways[:LRU|RAN]])");
+                    ok = 0;
+                }
+                break;
+
+            case 'L':
+                if (!strcmp(optarg,"FLAT"))
+                    p->layoutkind = LAYOUT_FLAT;
+                else if (!strcmp(optarg,"INV"))
+                    p->layoutkind = LAYOUT_INV;
+                else if (!strncmp(optarg,"2L",2) &&
+                         (optarg[2]=='\0' ||
+                          (sscanf(optarg+2,":%d",&p->layoutperlevel)==1 &&
+                           p->layoutperlevel>0)))
+                    p->layoutkind = LAYOUT_2L;
+                else
+                {
+                    fprintf (stderr,
+                             "\n    ERROR: wrong page table layout "
+                                          "(FLAT, 2L[:n] or INV)");
+                    ok = 0;
+                }
+                break;
+
+            case 'e':
+                memset (&p->cost, 0, sizeof(p->cost));
+                n = sscanf (optarg, "%lf,%lf,%lf,%lf,%lf",
+                            &p->cost.memtime, &p->cost.faulttime,
+                            &p->cost.writebacktime, &p->cost.tlbtime,
+                            &p->cost.tlbhitratio);
+
+                if (n<3 || p->cost.memtime<0 ||
+                    p->cost.faulttime<0 || p->cost.writebacktime<0 ||
+                    p->cost.tlbtime<0 || p->cost.tlbhitratio<0 ||
+                    p->cost.tlbhitratio>1)
+                {
+                    fprintf (stderr,
+                             "\n    ERROR: wrong cost model");
+                    ok = 0;
+                }
+
+                p->costmodel = n;    // 4 = hit ratio of the TLB (-T)
+                break;
+
+            case 'l':
+                if (sscanf(optarg,"%d",&p->lowwater)!=1 ||
+                    p->lowwater<1)
+                {
+                    fprintf (stderr,
+                             "\n    ERROR: wrong low watermark");
+                    ok = 0;
+                }
+                break;
+
+            case 'c':
+                if (sscanf(optarg,"%d",&p->curvemax)!=1 ||
+                    p->curvemax<1)
+                {
+                    fprintf (stderr,
+                             "\n    ERROR: wrong curve size");
+                    ok = 0;
+                }
+                break;
+
+            default:
+                ok = 0;
+        }
+
+    argc -= optind-1;
+    argv += optind-1;
 
     if (argc>7)
     {
@@ -190,8 +1288,6 @@ int parse_command (int argc, char * argv[], sparameters * p)
     }
     else
     {
-        ok = 1;
-
         if (argc>1 && (sscanf(argv[1],"%d",&p->pagsz)!=1 ||
                        p->pagsz<1))
         {
@@ -254,12 +1350,99 @@ int parse_command (int argc, char * argv[], sparameters * p)
         }
     }
 
+    if (p->costmodel==4 && !p->tlbentries)
+    {
+        fprintf (stderr,
+                 "\n    ERROR: the TLB of -e needs a hit ratio, "
+                              "or the one of -T");
+        ok = 0;
+    }
+
+    if (p->adaptive && !p->readahead)
+    {
+        fprintf (stderr,
+                 "\n    ERROR: -a needs the readahead of -r");
+        ok = 0;
+    }
+
+    if (p->inprocess && p->tracefile)
+    {
+        fprintf (stderr,
+                 "\n    ERROR: -i and -f are incompatible");
+        ok = 0;
+    }
+
+    if (!p->seriesinterval != !p->seriesfile)
+    {
+        fprintf (stderr,
+                 "\n    ERROR: the time series needs both -s|-S "
+                              "and -o");
+        ok = 0;
+    }
+
+    if (p->collapse && (p->detailed || p->tlbentries || p->layoutkind ||
+                        p->lowwater || p->readahead || p->curvemax ||
+                        p->profile || p->seriesinterval))
+    {
+        fprintf (stderr,
+                 "\n    ERROR: -R only works with the counters of "
+                              "every reference (not with detailed mode,\n"
+                 "    -T, -L, -l, -r, -c, -P, -s or -S)");
+        ok = 0;
+    }
+
+    if (p->nummix && (p->configs || p->tracefile || p->inprocess ||
+                      p->curvemax || p->collapse || p->profile ||
+                      p->seriesinterval))
+    {
+        fprintf (stderr,
+                 "\n    ERROR: -M does not work with -m, -f, -i, -c, "
+                              "-R, -P, -s or -S");
+        ok = 0;
+    }
+
+    if (p->nummix && p->localmix && p->numframes<p->nummix)
+    {
+        fprintf (stderr,
+                 "\n    ERROR: less frames than processes for -d");
+        ok = 0;
+    }
+
+    if (!p->nummix && (p->localmix || p->quantum!=DEFAULT_QUANTUM))
+    {
+        fprintf (stderr,
+                 "\n    ERROR: -d and -q need the workload mix of -M");
+        ok = 0;
+    }
+
+    if (p->round && !p->configs)
+    {
+        fprintf (stderr,
+                 "\n    ERROR: -k needs the configurations of -m");
+        ok = 0;
+    }
+
+    if (p->curvemax && p->policy && strcmp(p->policy->name,"LRU"))
+    {
+        fprintf (stderr,
+                 "\n    ERROR: the fault curve (-c) needs the LRU policy");
+        ok = 0;
+    }
+
+    if (p->configs && (p->detailed || p->curvemax))
+    {
+        fprintf (stderr,
+                 "\n    ERROR: -m does not work with detailed "
+                              "mode or -c");
+        ok = 0;
+    }
+
     if (ok)
         return 0;
 
     fprintf (stderr,
-             "\n\n    USAGE:\n\t%s pagesize numframes alg "
-                          "initord numelem mode\n\n", argv[0]);
+             "\n\n    USAGE:\n\t%s [options] pagesize numframes alg "
+                          "initord numelem mode\n\n", prog);
 
     fprintf (stderr,
              "\tpagesize: # of elements that fit in a page\n"
@@ -268,15 +1451,104 @@ int parse_command (int argc, char * argv[], sparameters * p)
              "\tinitord: initial state of the array (%s)\n"
              "\tnumelem: # of elements to be sorted\n"
              "\tmode: normal(N) or detailed(D)\n"
+             "\n"
+             "    OPTIONS:\n"
+             "\t-p policy: replacement policy (by default, the one\n"
+             "\t           in the name of the program, or %s)\n"
+             "\t-b: read the trace in compact binary format\n"
+             "\t-f file: replay a trace stored by gen_trace -o\n"
+             "\t         (alg, initord and numelem are ignored)\n"
+             "\t-i: run the sort inside the simulator, without\n"
+             "\t    gen_trace nor any trace in between\n"
+             "\t-x: exact LRU with an O(1) stack instead of the\n"
+             "\t    LRU(t) timestamp search (LRU only)\n"
+             "\t-c n: also print the LRU faults and write backs\n"
+             "\t      for 1..n frames, in one pass (LRU only)\n"
+             "\t-t n: window of the working set (WS), or longest\n"
+             "\t      time between faults that doesn't shrink the\n"
+             "\t      resident set (PFF), in references (%d)\n"
+             "\t-m list: simulate several configurations over the\n"
+             "\t         same trace, one row of results for each:\n"
+             "\t         POLICY:numframes[:pagesize],...\n"
+             "\t         (numframes in the command line is ignored,\n"
+             "\t         pagesize is the one by default)\n"
+             "\t-j n: threads simulating the configurations of -m\n"
+             "\t      (by default, one per processor)\n"
+             "\t-k n: simulate the configurations of -m n at a time,\n"
+             "\t      reading the trace again for every round, with\n"
+             "\t      the tables of a round in place of the previous\n"
+             "\t      ones (by default, all of them at once)\n"
+             "\t-r n: at a page fault, also load the next n pages\n"
+             "\t      (readahead; not with OPT)\n"
+             "\t-a: adaptive readahead, only for sequential faults,\n"
+             "\t    doubling from 2 pages up to the n of -r\n"
+             "\t-l n: page cleaner: in the references without a\n"
+             "\t      fault, write dirty pages back in advance while\n"
+             "\t      there are less than n frames free or clean\n"
+             "\t-e mem,fault,wb[,tlb[,hit]]: cost model, in ns, of an\n"
+             "\t      access to memory, a fault and a write back\n"
+             "\t      (and a TLB lookup with its hit ratio, or the\n"
+             "\t      one of -T), to print the effective access\n"
+             "\t      time and the total time\n"
+             "\t-T entries[:ways[:LRU|RAN]]: TLB in front of the page\n"
+             "\t      table (fully associative, LRU, by default)\n"
+             "\t-L FLAT|2L[:n]|INV: model the memory and the walks\n"
+             "\t      of a flat, two-level (n entries per second-level\n"
+             "\t      table, %d) or inverted page table\n"
+             "\t-P: profile: time and calls of the reading of the\n"
+             "\t    trace, sim_mmu, the faults and the searches of\n"
+             "\t    victims, and how long those searches are\n"
+             "\t-s n: time series: every n references, the references,\n"
+             "\t      faults and write backs so far, the faults since\n"
+             "\t      the previous sample and the frames occupied, in\n"
+             "\t      CSV (-S n: in binary)\n"
+             "\t-o file: where the time series goes (file.n for the\n"
+             "\t         nth configuration of -m)\n"
+             "\t-R: simulate the consecutive references to the same\n"
+             "\t    page as one run, with the same results (not with\n"
+             "\t    OPT, detailed mode, -T, -L, -l, -r, -c, -P, -s or\n"
+             "\t    -S)\n"
+             "\t-M list: workload mix: several processes, each one\n"
+             "\t         with its own trace and pages, in turns over\n"
+             "\t         the same frames: alg:initord:numelem,...\n"
+             "\t         (alg, initord and numelem in the command\n"
+             "\t         line are ignored)\n"
+             "\t-q n: references of every turn in the mix (%d)\n"
+             "\t-d: local replacement in the mix: the frames are\n"
+             "\t    divided among the processes (by default, global)\n"
              "\n",
-             VALID_ALGORITHMS, VALID_INIT_ORD);
+             VALID_ALGORITHMS, VALID_INIT_ORD, DEFAULT_POLICY,
+             DEFAULT_WINDOW, DEFAULT_PERLEVEL, DEFAULT_QUANTUM);
+
+    fprintf (stderr, "    POLICIES:\n\t");
+
+    for (i=0; policies[i]; i++)
+        fprintf (stderr, "%s%s", i ? "/" : "", policies[i]->name);
 
     fprintf (stderr,
+             "\n\n"
              "    EXAMPLES:\n"
              "\t%s 16 32 MER RAN 1000\n"
              "\t%s 1 3 HEA DES 4 D\n"
+             "\t%s -b 16 32 SEL ASC 1000\n"
+             "\t%s -p FIFO2CH 16 8 HEA DES 1000\n"
+             "\t%s -p WS -t 500 16 64 QUI RAN 5000\n"
+             "\t%s -p ECLOCK 16 24 SEL RAN 1000\n"
+             "\t%s -m OPT:16,LRU:16,FIFO:16 -f sel.trc 16 16\n"
+             "\t%s -a -r 8 -m LRU:16,FIFO:16 16 16 BUB RAN 1000\n"
+             "\t%s -l 4 -m LRU:16,ECLOCK:16 16 16 HEA RAN 3000\n"
+             "\t%s -e 100,8e6,8e6 -m LRU:8,LRU:16,LRU:8:32 16 16\n"
+             "\t%s -T 16:4 -e 100,8e6,8e6,1 16 16 HEA RAN 3000\n"
+             "\t%s -L 2L:64 1 64 QUI RAN 100000\n"
+             "\t%s -P -p FIFO2CH 1 512 QUI RAN 100000\n"
+             "\t%s -s 1000 -o lru.csv 16 32 QUI RAN 5000\n"
+             "\t%s -R -m LRU:16,ARC:16,WS:64 64 16 QUI RAN 100000\n"
+             "\t%s -M QUI:RAN:5000,HEA:DES:3000,MER:RAN:2000 -q 1000 16 64\n"
+             "\t%s -m LRU:8,LRU:32,FIFO:8,FIFO:32:64 16 32 QUI RAN 5000\n"
+             "\t%s -k 2 -j 2 -m LRU:8,LRU:16,LRU:32,LRU:64 16 16 QUI RAN 5000\n"
              "\n",
-             argv[0], argv[0]);
+             prog, prog, prog, prog, prog, prog, prog, prog, prog, prog,
+             prog, prog, prog, prog, prog, prog, prog, prog);
 
     return -1;
 }
@@ -0,0 +1,250 @@
+/*
+    Copyright 2023 The Operating System Group at the UAH
+    sim_pag_mix.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "./sim_paging.h"
+
+// Workload mix (-M): every process reads its own trace from its
+// own gen_trace, and they take turns (round robin, quantum
+// references each) over the same frames (see sim_paging.h).
+// A process that ends keeps its frames until the policy takes
+// them: the fixed allocation policies have no way to give a frame
+// back, and its pages are never referenced again anyway.
+
+typedef struct {
+  const smixspec* spec;
+  strace T;
+  sref refs[TRACE_BLOCK];  // Block of its trace
+  int n, pos;              // Operations in refs and next one
+  char done;               // 1 = its trace has ended
+  ssystem* S;              // Its system (the only one, if global)
+  int base, numpags;       // Its first page in S, and how many
+  unsigned long long numrefs, faults, writebacks;  // Its own; the
+                           // write backs of its faults (the victim
+                           // may be a page of another process)
+  unsigned long long illegal;  // References out of its pages
+  // Working set, over window references of its own
+  unsigned long long now;  // References so far
+  unsigned long long* lastref;  // Of every page (0 = never)
+  int* ring;               // Pages of the last window references
+  int ws, maxws;           // Pages in the working set, and peak
+  unsigned long long sumws;     // ws at every reference
+} sprocess;
+
+// Function that simulates a reference of process P
+
+static void mix_reference(sprocess* P, const sref* r) {
+  ssystem* S = P->S;
+  unsigned long long faults = S->numpagefaults;
+  unsigned long long writebacks = S->numpgwriteback;
+  unsigned window = S->window;
+  unsigned page = r->elem / S->pagsz;
+  unsigned long long t, *lastref = P->lastref;
+  int old;
+
+  if (page >= (unsigned)P->numpags) {  // Not into another process
+    P->illegal++;
+    return;
+  }
+
+  sim_mmu(S, P->base * S->pagsz + r->elem, r->op);
+
+  P->numrefs++;
+  P->faults += S->numpagefaults - faults;
+  P->writebacks += S->numpgwriteback - writebacks;
+
+  // The reference window ago leaves the window, and this one comes
+  t = ++P->now;
+
+  if (t > window) {
+    old = P->ring[t % window];
+
+    if (lastref[old] == t - window) P->ws--;
+  }
+
+  if (!lastref[page] || lastref[page] + window <= t) P->ws++;
+
+  lastref[page] = t;
+  P->ring[t % window] = page;
+
+  if (P->ws > P->maxws) P->maxws = P->ws;
+
+  P->sumws += P->ws;
+}
+
+// Function that runs the processes in turns until every trace ends
+// (-1 if some trace was wrong)
+
+static int mix_run(sprocess* procs, int n, int quantum) {
+  sprocess* P;
+  int alive, k, q, ok = 1;
+
+  for (alive = n, k = 0; alive > 0; k = (k + 1) % n) {
+    P = &procs[k];
+
+    for (q = 0; !P->done && q < quantum;) {
+      if (P->pos == P->n) {
+        P->n = trace_read(&P->T, P->refs, TRACE_BLOCK);
+        P->pos = 0;
+
+        if (P->n <= 0) {
+          if (P->n < 0) ok = 0;
+          P->done = 1;
+          alive--;
+          break;
+        }
+      }
+
+      if (P->refs[P->pos].op != 'C') {
+        mix_reference(P, &P->refs[P->pos]);
+        q++;
+      }
+
+      P->pos++;
+    }
+  }
+
+  return ok ? 0 : -1;
+}
+
+// Function that shows the results of every process, and whether
+// their working sets fit in the frames
+
+static void mix_report(sprocess* procs, int n, const ssystem* model,
+                       char local) {
+  sprocess* P;
+  unsigned long long refs = 0, faults = 0, writebacks = 0;
+  double meanws, demand = 0;
+  int k, over = 0;
+
+  printf("%-5s %-9s %-7s %8s %7s %7s %12s %10s %10s %8s %8s %6s\n",
+         "PROC", "ALGORITHM", "INITIAL", "NUMELEM", "PAGES", "FRAMES",
+         "REFS", "FAULTS", "WRITEBACKS", "FLT/KREF", "MEANWS", "MAXWS");
+
+  for (k = 0; k < n; k++) {
+    P = &procs[k];
+    meanws = P->numrefs ? P->sumws / (double)P->numrefs : 0;
+    demand += meanws;
+
+    if (local && meanws > P->S->numframes) over++;
+
+    refs += P->numrefs;
+    faults += P->faults;
+    writebacks += P->writebacks;
+
+    printf("%-5d %-9s %-7s %8d %7d %7d %12llu %10llu %10llu %8.2f %8.2f "
+           "%6d\n", k + 1, P->spec->algorithm, P->spec->initialstate,
+           P->spec->numelem, P->numpags, P->S->numframes, P->numrefs,
+           P->faults, P->writebacks,
+           P->numrefs ? 1000.0 * P->faults / P->numrefs : 0, meanws,
+           P->maxws);
+
+    if (P->illegal)
+      printf("      (%llu references out of its pages)\n", P->illegal);
+  }
+
+  printf("%-5s %-9s %-7s %8s %7s %7d %12llu %10llu %10llu %8.2f %8.2f\n",
+         "ALL", "", "", "", "", model->numframes, refs, faults, writebacks,
+         refs ? 1000.0 * faults / refs : 0, demand);
+
+  printf("\nWorking sets (window %d references): %.2f pages on average,",
+         model->window, demand);
+
+  if (local)
+    printf(" %d process(es) over their share of the frames: %s\n", over,
+           over ? "thrashing" : "no thrashing");
+  else
+    printf(" for %d frames: %s\n", model->numframes,
+           demand > model->numframes ? "thrashing" : "no thrashing");
+}
+
+int simulate_mix(const ssystem* model, const smixspec* specs, int n,
+                 int quantum, char local, char binary) {
+  char command[100];
+  sprocess* procs;
+  ssystem* systems;  // One per process (local), or one for all
+  sprocess* P;
+  int k, pages, ok = 1;
+
+  procs = (sprocess*)calloc(n, sizeof(sprocess));
+  systems = (ssystem*)calloc(local ? n : 1, sizeof(ssystem));
+
+  if (!procs || !systems) {
+    fprintf(stderr, "ERROR: not enough dynamic memory\n");
+    free(procs);
+    free(systems);
+    return -1;
+  }
+
+  printf("# Workload mix:  %d processes, quantum of %d references, %s "
+         "replacement\n", n, quantum, local ? "local" : "global");
+
+  for (k = 0, pages = 0; ok && k < n; k++) {
+    P = &procs[k];
+    P->spec = &specs[k];
+
+    sprintf(command, "./gen_trace %s%s %s %d", binary ? "-b " : "",
+            specs[k].algorithm, specs[k].initialstate, specs[k].numelem);
+    printf("# Process %d:  %s\n", k + 1, command);
+
+    if (trace_open(&P->T, command) < 0) {
+      ok = 0;
+      break;
+    }
+
+    P->numpags = (P->T.totalsz + model->pagsz - 1) / model->pagsz;
+    P->base = local ? 0 : pages;
+    pages += P->numpags;
+
+    P->lastref =
+        (unsigned long long*)calloc(P->numpags, sizeof(unsigned long long));
+    P->ring = (int*)malloc(model->window * sizeof(int));
+
+    if (!P->lastref || !P->ring) {
+      fprintf(stderr, "ERROR: not enough dynamic memory\n");
+      ok = 0;
+    }
+  }
+
+  // The frames, in equal shares (local), or for all of them
+  for (k = 0; ok && k < (local ? n : 1); k++) {
+    systems[k] = *model;
+
+    if (local)
+      systems[k].numframes = model->numframes / n +
+                             (k < model->numframes % n);
+
+    if (create_tables(&systems[k],
+                      (unsigned)(local ? procs[k].numpags : pages) *
+                          model->pagsz) < 0) {
+      fprintf(stderr, "ERROR: not enough dynamic memory\n");
+      ok = 0;
+    }
+  }
+
+  for (k = 0; k < n; k++) procs[k].S = &systems[local ? k : 0];
+
+  if (ok) ok = mix_run(procs, n, quantum) == 0;
+
+  if (ok) mix_report(procs, n, model, local);
+
+  for (k = 0; k < n; k++) {
+    P = &procs[k];
+
+    if (P->T.buf && trace_close(&P->T) < 0) ok = 0;
+
+    free(P->lastref);
+    free(P->ring);
+  }
+
+  for (k = 0; k < (local ? n : 1); k++) free_tables(&systems[k]);
+
+  free(systems);
+  free(procs);
+
+  return ok ? 0 : -1;
+}
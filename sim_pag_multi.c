@@ -0,0 +1,198 @@
+/*
+    Copyright 2023 The Operating System Group at the UAH
+    sim_pag_multi.c
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./sim_paging.h"
+
+// Several systems are simulated over one single trace. The main
+// thread decodes the trace in blocks while the workers simulate
+// the previous block, each one on its own share of the systems
+// (system i belongs to worker i % numworkers). Since every system
+// has its own tables, the workers only meet at the barrier that
+// separates one block from the next one. The blocks are filled
+// from a trace (simulate_systems), from a trace already in memory
+// (simulate_recorded) or from a sort run inside the process
+// (multi_block/multi_submit):
+//
+//   main:    decode 0 | decode 1 | decode 2 | ...
+//   workers:          | simul. 0 | simul. 1 | simul. 2 | ...
+
+typedef struct {
+  smulti* M;
+  int id;
+  spagerun* runs;  // Its block in runs (-R), or NULL
+} sworker;
+
+struct smulti {
+  sref* block[2];  // Double buffer: one filled while the
+  int n[2];        // other is simulated (n = 0 -> end)
+  int k;           // The one being filled
+  pthread_barrier_t barrier;
+  ssystem* systems;
+  int numsystems, numworkers;
+  pthread_t* th;
+  sworker* w;
+  spagerun* runs;  // MULTI_BLOCK runs per worker, if -R
+};
+
+static void simulate_block(ssystem* S, const sref* refs, int n,
+                           spagerun* runs) {
+  int i;
+
+  if (S->collapse) {  // Every system, with its own page size
+    simulate_runs(S, runs, collapse_runs(refs, n, S->pagsz, runs));
+    return;
+  }
+
+  for (i = 0; i < n; i++)
+    if (refs[i].op != 'C')                   // If R/W,
+      sim_mmu(S, refs[i].elem, refs[i].op);  // simulate mem. access
+}
+
+static void* worker(void* arg) {
+  sworker* w = (sworker*)arg;
+  smulti* M = w->M;
+  int k, s;
+
+  for (k = 0;; k = 1 - k) {
+    pthread_barrier_wait(&M->barrier);  // Block k ready
+
+    if (M->n[k] == 0) break;
+
+    for (s = w->id; s < M->numsystems; s += M->numworkers)
+      simulate_block(&M->systems[s], M->block[k], M->n[k], w->runs);
+  }
+
+  return NULL;
+}
+
+smulti* multi_start(ssystem* systems, int numsystems, int numworkers) {
+  smulti* M;
+  int i, collapse;
+
+  if (numworkers > numsystems) numworkers = numsystems;
+  if (numworkers < 1) numworkers = 1;
+
+  for (i = 0, collapse = 0; i < numsystems; i++)  // Any with -R
+    collapse |= systems[i].collapse;
+
+  M = (smulti*)malloc(sizeof(smulti));
+
+  if (M) {
+    M->block[0] = (sref*)malloc(2 * MULTI_BLOCK * sizeof(sref));
+    M->th = (pthread_t*)malloc(numworkers * sizeof(pthread_t));
+    M->w = (sworker*)malloc(numworkers * sizeof(sworker));
+    M->runs = collapse ? (spagerun*)malloc(numworkers * MULTI_BLOCK *
+                                           sizeof(spagerun))
+                       : NULL;
+  }
+
+  if (!M || !M->block[0] || !M->th || !M->w || (collapse && !M->runs)) {
+    fprintf(stderr, "ERROR: not enough dynamic memory\n");
+    if (M) {
+      free(M->block[0]);
+      free(M->th);
+      free(M->w);
+      free(M->runs);
+    }
+    free(M);
+    return NULL;
+  }
+
+  M->block[1] = M->block[0] + MULTI_BLOCK;
+  M->k = 0;
+  M->systems = systems;
+  M->numsystems = numsystems;
+  M->numworkers = numworkers;
+
+  pthread_barrier_init(&M->barrier, NULL, numworkers + 1);
+
+  for (i = 0; i < numworkers; i++) {
+    M->w[i].M = M;
+    M->w[i].id = i;
+    M->w[i].runs = M->runs ? M->runs + i * MULTI_BLOCK : NULL;
+
+    if (pthread_create(&M->th[i], NULL, worker, &M->w[i])) {
+      // The barrier would never open for the ones already started
+      fprintf(stderr, "ERROR: cannot start the worker threads\n");
+      exit(-1);
+    }
+  }
+
+  return M;
+}
+
+sref* multi_block(smulti* M) { return M->block[M->k]; }
+
+static void hand_block(smulti* M, int n) {
+  M->n[M->k] = n;
+
+  // Wait for the workers to finish the previous block, and let
+  // them take this one
+  pthread_barrier_wait(&M->barrier);
+
+  M->k = 1 - M->k;
+}
+
+void multi_submit(smulti* M, int n) {
+  // An empty block would end the workers: only multi_finish
+  if (n > 0) hand_block(M, n);
+}
+
+void multi_finish(smulti* M) {
+  int i;
+
+  hand_block(M, 0);  // Tell the workers to end
+
+  for (i = 0; i < M->numworkers; i++) pthread_join(M->th[i], NULL);
+
+  pthread_barrier_destroy(&M->barrier);
+  free(M->block[0]);
+  free(M->th);
+  free(M->w);
+  free(M->runs);
+  free(M);
+}
+
+int simulate_systems(strace* T, ssystem* systems, int numsystems,
+                     int numworkers) {
+  smulti* M;
+  int n;
+
+  M = multi_start(systems, numsystems, numworkers);
+
+  if (!M) return -1;
+
+  while ((n = trace_read(T, multi_block(M), MULTI_BLOCK)) > 0)
+    multi_submit(M, n);
+
+  multi_finish(M);
+
+  return n < 0 ? -1 : 0;
+}
+
+int simulate_recorded(const sref* refs, unsigned n, ssystem* systems,
+                      int numsystems, int numworkers) {
+  smulti* M;
+  int chunk;
+
+  M = multi_start(systems, numsystems, numworkers);
+
+  if (!M) return -1;
+
+  for (; n > 0; refs += chunk, n -= chunk) {
+    chunk = n < MULTI_BLOCK ? n : MULTI_BLOCK;
+    memcpy(multi_block(M), refs, chunk * sizeof(sref));
+    multi_submit(M, chunk);
+  }
+
+  multi_finish(M);
+
+  return 0;
+}
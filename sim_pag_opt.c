@@ -0,0 +1,186 @@
+/*
+    Copyright 2023 The Operating System Group at the UAH
+    sim_pag_opt.c
+ */
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./sim_paging.h"
+
+// Optimal replacement (Belady's OPT): the victim is the page that
+// will be used again furthest in the future, which gives the
+// minimum number of page faults for a given number of frames.
+// It needs the whole trace in advance (know_future), so that
+// one backward pass gives, for every reference, the position of
+// the next reference to the same page. The frames are kept in a
+// max-heap by the next use of their pages, so choosing a victim
+// costs O(log numframes) instead of searching the future.
+
+#define NEVER UINT_MAX  // The page is not used again
+
+typedef struct {
+  unsigned* next;     // next[t] = time of the next reference to the
+                      // page of reference t (or NEVER)
+  unsigned numrefs;   // References in the trace
+  unsigned now;       // Time (index) of the current reference
+  unsigned* key;      // Next use of the page in each frame
+  int* heap;          // Max-heap of occupied frames by key
+  int* pos;           // Position of each frame in the heap
+  int heapsize;
+} sfuture;
+
+static void heap_swap(sfuture* F, int i, int j) {
+  int fi = F->heap[i], fj = F->heap[j];
+
+  F->heap[i] = fj;
+  F->pos[fj] = i;
+  F->heap[j] = fi;
+  F->pos[fi] = j;
+}
+
+static void heap_update(sfuture* F, int frame) {  // Key changed
+  int i = F->pos[frame], child;
+
+  while (i > 0 && F->key[F->heap[(i - 1) / 2]] < F->key[F->heap[i]]) {
+    heap_swap(F, i, (i - 1) / 2);
+    i = (i - 1) / 2;
+  }
+
+  for (;;) {
+    child = 2 * i + 1;
+
+    if (child >= F->heapsize) break;
+
+    if (child + 1 < F->heapsize &&
+        F->key[F->heap[child + 1]] > F->key[F->heap[child]])
+      child++;
+
+    if (F->key[F->heap[child]] <= F->key[F->heap[i]]) break;
+
+    heap_swap(F, i, child);
+    i = child;
+  }
+}
+
+// Functions that create and initialise the tables
+
+static int opt_know_future(ssystem* S, const sref* refs, unsigned n) {
+  sfuture* F;
+  unsigned* last;
+  unsigned t, i;
+  int page;
+
+  for (t = 0, i = 0; i < n; i++)  // Only the legal ones reach
+    if (refs[i].elem / S->pagsz < (unsigned)S->numpags) t++;  // the pages
+
+  // A single block, so that a plain free() releases everything
+  F = (sfuture*)arena_alloc(
+      S->arena, sizeof(sfuture) + t * sizeof(unsigned) +
+                    S->numframes * (sizeof(unsigned) + 2 * sizeof(int)) +
+                    S->numpags * sizeof(unsigned));
+
+  if (!F) return -1;
+
+  F->next = (unsigned*)(F + 1);
+  F->key = F->next + t;
+  F->heap = (int*)(F->key + S->numframes);
+  F->pos = F->heap + S->numframes;
+  last = (unsigned*)(F->pos + S->numframes);
+  F->numrefs = t;
+
+  for (page = 0; page < S->numpags; page++) last[page] = NEVER;
+
+  for (i = n; i-- > 0;) {
+    page = refs[i].elem / S->pagsz;
+
+    if (page < S->numpags) {
+      F->next[--t] = last[page];
+      last[page] = t;
+    }
+  }
+
+  F->now = F->heapsize = 0;
+
+  arena_release(S->arena, S->data);
+  S->data = F;
+  return 0;
+}
+
+static void opt_init_tables(ssystem* S) {
+  sfuture* F = (sfuture*)S->data;
+
+  if (F) F->now = F->heapsize = 0;
+}
+
+// Functions that simulate the hardware of the MMU
+
+static void opt_reference_page(ssystem* S, int page, char op) {
+  sfuture* F = (sfuture*)S->data;
+  int frame = PAGE(S, page, frame);
+
+  // Past the end of the known trace, nothing is used again
+  F->key[frame] = F->now < F->numrefs ? F->next[F->now] : NEVER;
+  F->now++;
+  heap_update(F, frame);
+}
+
+// Functions that simulate the operating system
+
+static int opt_choose_page_to_be_replaced(ssystem* S, int newpage) {
+  sfuture* F = (sfuture*)S->data;
+  int frame = F->heap[0];
+  int victim = S->frt[frame].page;
+
+  if (S->detailed) {
+    if (F->key[frame] == NEVER)
+      printf("@ Choosing P %d (not used again) from M %d for "
+             "replacement\n", victim, frame);
+    else
+      printf("@ Choosing P %d (used again in %u references) from M %d "
+             "for replacement\n", victim, F->key[frame] - F->now, frame);
+  }
+
+  return victim;  // Its frame keeps its place in the heap
+}
+
+static void opt_occupy_free_frame(ssystem* S, int frame, int page) {
+  sfuture* F = (sfuture*)S->data;
+
+  F->key[frame] = F->now;  // Updated by the reference itself
+  F->heap[F->heapsize] = frame;
+  F->pos[frame] = F->heapsize++;
+}
+
+// Functions that show results
+
+static void opt_print_replacement_report(ssystem* S) {
+  sfuture* F = (sfuture*)S->data;
+  int frame;
+
+  printf("Optimal replacement policy (OPT), %u references known\n",
+         F->numrefs);
+  printf("Next use of the page in each frame:\n");
+
+  for (frame = 0; frame < S->numframes; frame++)
+    if (S->frt[frame].page != -1) {
+      if (F->key[frame] == NEVER)
+        printf("  M %d -> P %d (never)%s\n", frame, S->frt[frame].page,
+               frame == F->heap[0] ? " <- next victim" : "");
+      else
+        printf("  M %d -> P %d (at %u)%s\n", frame, S->frt[frame].page,
+               F->key[frame], frame == F->heap[0] ? " <- next victim" : "");
+    }
+}
+
+const spolicy policy_opt = {
+    .name = "OPT",
+    .know_future = opt_know_future,
+    .init_tables = opt_init_tables,
+    .reference_page = opt_reference_page,
+    .choose_page_to_be_replaced = opt_choose_page_to_be_replaced,
+    .occupy_free_frame = opt_occupy_free_frame,
+    .print_replacement_report = opt_print_replacement_report,
+};
@@ -0,0 +1,134 @@
+/*
+    Copyright 2023 The Operating System Group at the UAH
+    sim_pag_pff.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./sim_paging.h"
+
+// Page Fault Frequency policy (variable allocation): at every
+// page fault, if the last one was more than window references
+// ago (few faults), the pages not referenced since then are
+// released; otherwise (many faults) the resident set just grows
+// with the new page. The reference bits are cleared at every
+// fault. If there is no free frame left, the least recently used
+// page is replaced, so the pages are also kept in the LRU stack.
+
+// Functions that simulate the hardware of the MMU
+
+static void pff_reference_page(ssystem* S, int page, char op) {
+  int frame = PAGE(S, page, frame);
+
+  PAGE_SET(S, page, referenced, 1);
+  PAGE_SET(S, page, timestamp, STAMP(S));
+  S->clock++;
+
+  if (S->lru != frame) {
+    lru_stack_unlink(S, frame);
+    lru_stack_push(S, frame);
+  }
+}
+
+static void pff_reference_run(ssystem* S, int page, unsigned n) {
+  S->clock += n - 1;  // Only the last one leaves a mark
+  pff_reference_page(S, page, 'R');
+
+  S->sumresident += (unsigned long long)n * S->numresident;
+}
+
+// Functions that simulate the operating system
+
+static void pff_page_fault(ssystem* S, int page) {
+  int frame, next, n, shrink;
+
+  shrink = S->clock - S->lastfault > (unsigned long long)S->window;
+
+  if (S->detailed && shrink) {
+    printf("@ %llu references since the last fault: shrinking\n",
+           S->clock - S->lastfault);
+  }
+
+  frame = S->lru;
+
+  for (n = S->numresident; n > 0; n--) {
+    next = S->frt[frame].next;
+
+    if (shrink && !PAGE(S, S->frt[frame].page, referenced))
+      release_frame(S, S->frt[frame].page);
+    else
+      PAGE_SET(S, S->frt[frame].page, referenced, 0);
+
+    frame = next;
+  }
+
+  S->lastfault = S->clock;
+}
+
+static int pff_choose_page_to_be_replaced(ssystem* S, int newpage) {
+  int frame = S->frt[S->lru].prev, victim;
+
+  while (PINNED(S, S->frt[frame].page)) frame = S->frt[frame].prev;
+
+  victim = S->frt[frame].page;  // The LRU one (see read_ahead)
+
+  if (S->detailed) {
+    printf("@ Choosing P %d (no free frames, LRU) from M %d for "
+           "replacement\n", victim, PAGE(S, victim, frame));
+  }
+
+  return victim;
+}
+
+static void pff_replace_page(ssystem* S, int victim, int newpage) {
+  int frame = PAGE(S, newpage, frame);
+
+  lru_stack_unlink(S, frame);
+  lru_stack_push(S, frame);
+}
+
+static void pff_occupy_free_frame(ssystem* S, int frame, int page) {
+  lru_stack_push(S, frame);
+}
+
+static void pff_release_frame(ssystem* S, int frame, int page) {
+  lru_stack_unlink(S, frame);
+}
+
+// Functions that show results
+
+static void pff_print_replacement_report(ssystem* S) {
+  int frame;
+
+  printf("Page Fault Frequency policy, threshold = %d references\n",
+         S->window);
+  printf("Current clock value: %llu (last fault at %llu)\n", S->clock,
+         S->lastfault);
+
+  if (S->lru != -1) {
+    printf("Resident set (most recently used first):\n");
+
+    frame = S->lru;
+
+    do {
+      printf("  M %d -> P %d%s\n", frame, S->frt[frame].page,
+             PAGE(S, S->frt[frame].page, referenced) ? " (referenced)" : "");
+      frame = S->frt[frame].next;
+    } while (frame != S->lru);
+  }
+}
+
+const spolicy policy_pff = {
+    .name = "PFF",
+    .variable = 1,
+    .reference_page = pff_reference_page,
+    .choose_page_to_be_replaced = pff_choose_page_to_be_replaced,
+    .replace_page = pff_replace_page,
+    .occupy_free_frame = pff_occupy_free_frame,
+    .page_fault = pff_page_fault,
+    .release_frame = pff_release_frame,
+    .reference_run = pff_reference_run,
+    .print_replacement_report = pff_print_replacement_report,
+};
@@ -0,0 +1,56 @@
+/*
+    Copyright 2023 The Operating System Group at the UAH
+    sim_pag_prof.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "./sim_paging.h"
+
+// Profile of a simulation (-P). Every stage adds the ticks between
+// its beginning and its end, so a stage includes the ones it calls
+// (a fault includes the search of its victim). The ticks are the
+// ones of the time stamp counter where there is one, which costs a
+// few nanoseconds per reading, and are turned into time with the
+// rate measured over the whole simulation.
+
+unsigned long long prof_clock_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+sprofile* prof_create(sarena* A) {
+  sprofile* P = (sprofile*)arena_alloc(A, sizeof(sprofile));
+
+  if (P) prof_reset(P);
+
+  return P;
+}
+
+void prof_reset(sprofile* P) {
+  memset(P, 0, sizeof(sprofile));
+
+  P->startns = prof_clock_ns();
+  P->startticks = PROF_TICKS();
+}
+
+void prof_victim(sprofile* P, unsigned long long steps) {
+  int b;
+
+  // Bucket b holds [2^b, 2^(b+1)) steps (0 steps go to bucket 0)
+  for (b = 0; steps > 1 && b < PROF_BUCKETS - 1; b++) steps >>= 1;
+
+  P->hist[b]++;
+}
+
+double prof_ticks_per_ns(const sprofile* P) {
+  unsigned long long ns = prof_clock_ns() - P->startns;
+
+  return ns ? (PROF_TICKS() - P->startticks) / (double)ns : 1;
+}
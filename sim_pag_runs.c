@@ -0,0 +1,68 @@
+/*
+    Copyright 2023 The Operating System Group at the UAH
+    sim_pag_runs.c
+ */
+
+#include "./sim_paging.h"
+
+// Runs of references to the same page (-R). The sorts go over
+// consecutive elements most of the time, so with pages of 16
+// elements or more most references are to the page of the
+// previous one; the MMU and the policy only see where the page
+// changes (see sim_paging.h).
+
+int collapse_runs(const sref* refs, int n, int pagsz, spagerun* runs) {
+  unsigned first = 0;  // First element of the page of runs[k]
+  int i, k = -1;
+
+  for (i = 0; i < n; i++) {
+    if (refs[i].op == 'C') continue;
+
+    // Another page (only then a division)
+    if (k < 0 || refs[i].elem - first >= (unsigned)pagsz) {
+      runs[++k].page = refs[i].elem / pagsz;
+      runs[k].count = runs[k].writes = 0;
+      first = runs[k].page * (unsigned)pagsz;
+    }
+
+    runs[k].count++;
+    runs[k].writes += refs[i].op == 'W';
+  }
+
+  return k + 1;
+}
+
+void simulate_runs(ssystem* S, const spagerun* runs, int n) {
+  const spagerun* r;
+  unsigned writes, rest;
+  int i;
+
+  for (i = 0, r = runs; i < n; i++, r++) {
+    if (r->page < 0 || r->page >= S->numpags) {
+      S->numillegalrefs += r->count;
+      continue;
+    }
+
+    // The writes go first: the page ends up modified either way,
+    // and it doesn't leave its frame during the run
+    writes = r->writes;
+    sim_mmu(S, r->page * S->pagsz, writes ? (writes--, 'W') : 'R');
+
+    if (r->count == 1) continue;
+
+    reference_page(S, r->page, writes ? (writes--, 'W') : 'R');
+
+    if (r->count == 2) continue;
+
+    rest = r->count - 2;
+    S->numrefswrite += writes;
+    S->numrefsread += rest - writes;
+
+    if (S->policy->reference_run)
+      S->policy->reference_run(S, r->page, rest);
+    else
+      S->sumresident += (unsigned long long)rest * S->numresident;
+
+    if (S->clock - S->clockbase >= STAMP_LIMIT) renormalize_timestamps(S);
+  }
+}
@@ -0,0 +1,93 @@
+/*
+    Copyright 2023 The Operating System Group at the UAH
+    sim_pag_series.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "./sim_paging.h"
+
+// Time series of the simulation (-s/-S): one sample every interval
+// references, formatted by hand into the buffer of an soutput (see
+// sim_paging.h for the two formats). The references are counted
+// down in sim_mmu, so that with no series the cost is one test.
+
+sseries* series_create(ssystem* S) {
+  char path[4096];
+  sseries* R;
+
+  if (S->seriesindex)  // One file for every system of -m
+    snprintf(path, sizeof(path), "%s.%d", S->seriesfile, S->seriesindex);
+  else
+    snprintf(path, sizeof(path), "%s", S->seriesfile);
+
+  R = (sseries*)malloc(sizeof(sseries));
+
+  if (!R) return NULL;
+
+  if (output_create(&R->out, path) < 0) {
+    free(R);
+    return NULL;
+  }
+
+  R->interval = R->countdown = S->seriesinterval;
+  R->refs = R->faults = R->writebacks = 0;
+
+  if (S->seriesbinary) {
+    output_bytes(&R->out, SERIES_MAGIC, SERIES_MAGIC_LEN);
+    output_varint(&R->out, R->interval);
+  } else {
+    output_bytes(&R->out, "refs,faults,writebacks,window_faults,resident\n",
+                 46);
+  }
+
+  return R;
+}
+
+void series_sample(ssystem* S) {
+  sseries* R = S->series;
+  soutput* O = &R->out;
+  unsigned long long refs = S->numrefsread + S->numrefswrite;
+
+  if (S->seriesbinary) {
+    output_varint(O, refs - R->refs);
+    output_varint(O, S->numpagefaults - R->faults);
+    output_varint(O, S->numpgwriteback - R->writebacks);
+    output_varint(O, S->numresident);
+  } else {
+    output_number(O, refs);
+    output_char(O, ',');
+    output_number(O, S->numpagefaults);
+    output_char(O, ',');
+    output_number(O, S->numpgwriteback);
+    output_char(O, ',');
+    output_number(O, S->numpagefaults - R->faults);
+    output_char(O, ',');
+    output_number(O, S->numresident);
+    output_char(O, '\n');
+  }
+
+  R->refs = refs;
+  R->faults = S->numpagefaults;
+  R->writebacks = S->numpgwriteback;
+  R->countdown = R->interval;
+}
+
+int series_close(ssystem* S) {
+  int ok;
+
+  if (!S->series) return 0;
+
+  // The references after the last sample
+  if (S->numrefsread + S->numrefswrite > S->series->refs) series_sample(S);
+
+  ok = output_close(&S->series->out) == 0;
+
+  if (!ok) fprintf(stderr, "ERROR writing the time series\n");
+
+  free(S->series);
+  S->series = NULL;
+
+  return ok ? 0 : -1;
+}
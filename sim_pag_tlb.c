@@ -0,0 +1,102 @@
+/*
+    Copyright 2023 The Operating System Group at the UAH
+    sim_pag_tlb.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./sim_paging.h"
+
+// TLB in front of the page table: numsets sets of ways entries
+// each, and page P can only be in set P % numsets. A hit saves the
+// access to the page table; a miss reads it (after the page fault,
+// if the page is not present) and loads the entry in its set, in
+// place of the least recently used one or of a random one. The
+// entry of a page is invalidated when the page leaves its frame,
+// so a hit always finds the page present.
+
+stlb* tlb_create(sarena* A, int entries, int ways, char random) {
+  stlb* T;
+
+  // A single block, so that arena_release() releases everything
+  T = (stlb*)arena_alloc(
+      A, sizeof(stlb) + entries * (sizeof(unsigned long long) + sizeof(int)));
+
+  if (!T) return NULL;
+
+  T->numsets = entries / ways;
+  T->ways = ways;
+  T->random = random;
+  T->stamp = (unsigned long long*)(T + 1);
+  T->page = (int*)(T->stamp + entries);
+
+  tlb_reset(T);
+  return T;
+}
+
+void tlb_reset(stlb* T) {
+  int i;
+
+  for (i = 0; i < T->numsets * T->ways; i++) {
+    T->page[i] = -1;
+    T->stamp[i] = 0;
+  }
+
+  T->clock = 0;
+  T->seed = 1;
+  T->hits = T->misses = T->invalidations = 0;
+}
+
+int tlb_lookup(stlb* T, int page) {
+  int i, set = page % T->numsets * T->ways;
+
+  T->clock++;
+
+  for (i = set; i < set + T->ways; i++)
+    if (T->page[i] == page) {
+      T->stamp[i] = T->clock;
+      T->hits++;
+      return 1;
+    }
+
+  T->misses++;
+  return 0;
+}
+
+void tlb_insert(stlb* T, int page) {
+  int i, victim, set = page % T->numsets * T->ways;
+
+  // A free entry, if any
+  for (i = set; i < set + T->ways && T->page[i] != -1; i++)
+    ;
+
+  if (i < set + T->ways) {
+    victim = i;
+  } else if (T->random) {
+    // Its own generator (xorshift), not to change the sequence of
+    // the RANDOM replacement policy
+    T->seed ^= T->seed << 13;
+    T->seed ^= T->seed >> 17;
+    T->seed ^= T->seed << 5;
+    victim = set + T->seed % T->ways;
+  } else {
+    for (victim = set, i = set + 1; i < set + T->ways; i++)
+      if (T->stamp[i] < T->stamp[victim]) victim = i;
+  }
+
+  T->page[victim] = page;
+  T->stamp[victim] = T->clock;
+}
+
+void tlb_invalidate(stlb* T, int page) {
+  int i, set = page % T->numsets * T->ways;
+
+  for (i = set; i < set + T->ways; i++)
+    if (T->page[i] == page) {
+      T->page[i] = -1;
+      T->invalidations++;
+      return;
+    }
+}
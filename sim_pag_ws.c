@@ -0,0 +1,116 @@
+/*
+    Copyright 2023 The Operating System Group at the UAH
+    sim_pag_ws.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./sim_paging.h"
+
+// Working Set policy (variable allocation): a page stays in memory
+// while it belongs to the working set W(t,window), that is, while
+// it has been referenced in the last window references, and its
+// frame goes back to the free list when it falls out. The pages
+// are kept in the LRU stack, so the ones leaving the window are
+// always at the bottom. If the working set doesn't fit in the
+// numframes frames, the least recently used page is replaced.
+
+// Functions that simulate the hardware of the MMU
+
+static void ws_reference_page(ssystem* S, int page, char op) {
+  int frame = PAGE(S, page, frame);
+  int oldest;
+
+  PAGE_SET(S, page, timestamp, STAMP(S));
+  S->clock++;
+
+  if (S->lru != frame) {
+    lru_stack_unlink(S, frame);
+    lru_stack_push(S, frame);
+  }
+
+  // Release the pages out of the window (never this one)
+  for (;;) {
+    oldest = S->frt[S->frt[S->lru].prev].page;
+
+    if (STAMP(S) - PAGE(S, oldest, timestamp) <= (unsigned)S->window) break;
+
+    release_frame(S, oldest);
+  }
+}
+
+static void ws_reference_run(ssystem* S, int page, unsigned n) {
+  // One by one: every reference may release pages, and the
+  // resident set is added up after each of them
+  for (; n > 0; n--) {
+    ws_reference_page(S, page, 'R');
+    S->sumresident += S->numresident;
+  }
+}
+
+// Functions that simulate the operating system
+
+static int ws_choose_page_to_be_replaced(ssystem* S, int newpage) {
+  int frame = S->frt[S->lru].prev, victim;
+
+  while (PINNED(S, S->frt[frame].page)) frame = S->frt[frame].prev;
+
+  victim = S->frt[frame].page;  // The LRU one (see read_ahead)
+
+  if (S->detailed) {
+    printf("@ Choosing P %d (working set too big, LRU) from M %d for "
+           "replacement\n", victim, PAGE(S, victim, frame));
+  }
+
+  return victim;
+}
+
+static void ws_replace_page(ssystem* S, int victim, int newpage) {
+  int frame = PAGE(S, newpage, frame);
+
+  lru_stack_unlink(S, frame);
+  lru_stack_push(S, frame);
+}
+
+static void ws_occupy_free_frame(ssystem* S, int frame, int page) {
+  lru_stack_push(S, frame);
+}
+
+static void ws_release_frame(ssystem* S, int frame, int page) {
+  lru_stack_unlink(S, frame);
+}
+
+// Functions that show results
+
+static void ws_print_replacement_report(ssystem* S) {
+  int frame;
+
+  printf("Working Set policy, window = %d references\n", S->window);
+  printf("Current clock value: %llu\n", S->clock);
+
+  if (S->lru != -1) {
+    printf("Working set (most recently used first):\n");
+
+    frame = S->lru;
+
+    do {
+      printf("  M %d -> P %d (age %u)\n", frame, S->frt[frame].page,
+             STAMP(S) - PAGE(S, S->frt[frame].page, timestamp));
+      frame = S->frt[frame].next;
+    } while (frame != S->lru);
+  }
+}
+
+const spolicy policy_ws = {
+    .name = "WS",
+    .variable = 1,
+    .reference_page = ws_reference_page,
+    .choose_page_to_be_replaced = ws_choose_page_to_be_replaced,
+    .replace_page = ws_replace_page,
+    .occupy_free_frame = ws_occupy_free_frame,
+    .release_frame = ws_release_frame,
+    .reference_run = ws_reference_run,
+    .print_replacement_report = ws_print_replacement_report,
+};
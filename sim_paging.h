@@ -5,6 +5,8 @@
 #ifndef _SIM_PAGING_H_
 #define _SIM_PAGING_H_
 
+#include "trace.h"
+
 // Structure that holds the state of a page,
 // sumulating an entry of the page table
 
@@ -14,11 +16,16 @@ typedef struct
     int frame;          // Frame where it is loaded
     char modified;      // 1 = must be written back to disc
                             // if moved out of the frame
-    // For FIFO 2nd chance
+    // For FIFO 2nd chance, CLOCK and PFF
     char referenced;    // 1 = page referenced recently
 
     // For LRU(t)
-    unsigned timestamp; // Time mark of last reference
+    unsigned timestamp; // Time mark of last reference (from
+                        // S->clockbase, see STAMP)
+
+    char prefetched;    // 1 = read ahead, not referenced yet
+    char cleaned;       // 1 = written back by the cleaner, not
+                        // modified again yet
 
     // NOTE: The previous two fiels are in this structure
     //       ---and not in sframe--- because they simulate
@@ -27,6 +34,60 @@ typedef struct
 }
 spage;
 
+// Layout of the page table. By default, an array of spage, one
+// per page. Compiled with -DPGT_SOA, a structure of arrays: one
+// bitset per flag and separate arrays of frames and timestamps,
+// so that the searches of present pages go 64 pages at a time
+// (next_present_page) and the timestamps are read sequentially.
+// Either way, the entries are accessed with PAGE and PAGE_SET.
+
+#ifdef PGT_SOA
+
+typedef struct
+{
+    unsigned long long * present;     // Bit p%64 of word p/64
+    unsigned long long * modified;    // is the flag of page p
+    unsigned long long * referenced;
+    unsigned long long * prefetched;
+    unsigned long long * cleaned;
+    int * frame;
+    unsigned * timestamp;
+    int numwords;                     // Of every bitset
+}
+spgt;
+
+#define PGT_GETBIT(b,p) ((int)((b)[(p)>>6] >> ((p)&63) & 1))
+#define PGT_SETBIT(b,p,v) ((v) ? ((b)[(p)>>6] |= 1ULL<<((p)&63)) \
+                               : ((b)[(p)>>6] &= ~(1ULL<<((p)&63))))
+
+#define PGT_GET_present(S,p)     PGT_GETBIT((S)->pgt->present,p)
+#define PGT_GET_modified(S,p)    PGT_GETBIT((S)->pgt->modified,p)
+#define PGT_GET_referenced(S,p)  PGT_GETBIT((S)->pgt->referenced,p)
+#define PGT_GET_prefetched(S,p)  PGT_GETBIT((S)->pgt->prefetched,p)
+#define PGT_GET_cleaned(S,p)     PGT_GETBIT((S)->pgt->cleaned,p)
+#define PGT_GET_frame(S,p)       ((S)->pgt->frame[p])
+#define PGT_GET_timestamp(S,p)   ((S)->pgt->timestamp[p])
+
+#define PGT_SET_present(S,p,v)     PGT_SETBIT((S)->pgt->present,p,v)
+#define PGT_SET_modified(S,p,v)    PGT_SETBIT((S)->pgt->modified,p,v)
+#define PGT_SET_referenced(S,p,v)  PGT_SETBIT((S)->pgt->referenced,p,v)
+#define PGT_SET_prefetched(S,p,v)  PGT_SETBIT((S)->pgt->prefetched,p,v)
+#define PGT_SET_cleaned(S,p,v)     PGT_SETBIT((S)->pgt->cleaned,p,v)
+#define PGT_SET_frame(S,p,v)       ((S)->pgt->frame[p] = (v))
+#define PGT_SET_timestamp(S,p,v)   ((S)->pgt->timestamp[p] = (v))
+
+#define PAGE(S,p,field)       PGT_GET_##field(S,p)
+#define PAGE_SET(S,p,field,v) PGT_SET_##field(S,p,v)
+
+#else
+
+typedef spage spgt;
+
+#define PAGE(S,p,field)       ((S)->pgt[p].field)
+#define PAGE_SET(S,p,field,v) ((S)->pgt[p].field = (v))
+
+#endif
+
 // Structure that holds the state of a frame
 // (the hardware doesn't know anything about this struct)
 
@@ -36,39 +97,383 @@ typedef struct
 
     // For managing free frames and for FIFO and FIFO 2nd ch.
     int next;           // Next frame in the list
+
+    // For exact LRU (next is reused for the same list)
+    int prev;           // Previous frame in the LRU stack
 }
 sframe;
 
+// Structure that computes the LRU stack distance of every
+// reference in a single pass, to obtain the page faults and
+// write backs of LRU for every number of frames from 1 to
+// maxframes at once (LRU has the inclusion property: the pages
+// in n frames are always a subset of the ones in n+1 frames).
+
+typedef struct
+{
+    int maxframes;         // Last point of the curve
+    unsigned long long numrefs;   // References seen
+    unsigned long long * hist;    // hist[d] = # of refs at distance
+                                  // d (1..maxframes; 0 unused)
+    long long * wbdiff;    // Write backs, as differences between
+                           // consecutive numbers of frames
+    unsigned * last;       // Slot of the last ref. of each page
+                           // (0 = never referenced)
+    int * sincewrite;      // Max. distance since the last write
+                           // of each page (maxframes+1 = none)
+    int * tree;            // Fenwick tree of marks over slots
+    int * slotpage;        // Page marked in each slot (or -1)
+    unsigned numslots;     // Size of the slots window
+    unsigned now;          // Last slot used
+    int marks;             // Pages with a mark in the window
+}
+scurve;
+
+// Structure that simulates a set-associative TLB (sim_pag_tlb.c)
+
+typedef struct
+{
+    int numsets, ways;     // Entries = numsets * ways
+    char random;           // 1 = random replacement in the set,
+                           // 0 = LRU
+    int * page;            // Page of every entry (-1 = invalid);
+                           // set s is [s*ways, (s+1)*ways)
+    unsigned long long * stamp;   // Time of the last use of every
+                                  // entry
+    unsigned long long clock;     // Lookups so far
+    unsigned seed;         // Generator of the random replacement
+    unsigned long long hits, misses;  // Lookups that found the
+                                      // page or not
+    unsigned long long invalidations; // Entries of pages that left
+                                      // memory
+}
+stlb;
+
+// Structure that models the layout of the page table used for
+// the translation (sim_pag_layout.c)
+
+#define LAYOUT_FLAT 1
+#define LAYOUT_2L 2     // Two levels
+#define LAYOUT_INV 3    // Inverted, hashed
+
+#define LAYOUT_PTE_BYTES 8  // Entry of a flat or second-level table,
+                            // and of the directory
+
+typedef struct
+{
+    char kind;             // LAYOUT_...
+    int perlevel;          // 2L: entries of a second-level table
+    int numpags, numtables, numbuckets, numframes;
+    int * count;           // 2L: pages loaded in the range of every
+                           // second-level table (0 = not allocated)
+    int * bucket;          // INV: first frame of every chain
+    int * ipage;           // INV: page in every frame
+    int * inext;           // INV: next frame in the chain
+    unsigned long long walks;     // Lookups in the page table
+    unsigned long long accesses;  // Accesses to memory in them
+    size_t bytes, peakbytes;      // Memory of the table (now, peak)
+}
+slayout;
+
+// Structure that accumulates the profile of a simulation (-P):
+// the ticks and calls of every stage, and a histogram of the steps
+// of the searches of victims, in powers of two (sim_pag_prof.c).
+// The ticks are the ones of the time stamp counter of the
+// processor, or nanoseconds where there is none.
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROF_TICKS() __rdtsc()
+#else
+#define PROF_TICKS() prof_clock_ns()
+#endif
+
+#define PROF_DECODE 0      // Reading the trace (one system only)
+#define PROF_MMU 1         // sim_mmu, with everything it calls
+#define PROF_FAULT 2       // handle_page_fault
+#define PROF_VICTIM 3      // choose_page_to_be_replaced
+#define PROF_STAGES 4
+#define PROF_BUCKETS 16    // 1, 2-3, 4-7... steps (the last one,
+                           // 2^15 and more)
+
+#define PROF_ADD(P,stage,t0) ((P)->ticks[stage] += PROF_TICKS()-(t0), \
+                              (P)->calls[stage]++)
+
+typedef struct
+{
+    unsigned long long ticks[PROF_STAGES];
+    unsigned long long calls[PROF_STAGES];
+    unsigned long long hist[PROF_BUCKETS];   // Searches by steps
+    unsigned long long startns, startticks;  // To measure the rate
+}
+sprofile;
+
+// Structure that writes a time series of the simulation (-s/-S):
+// every interval references, a sample with the references, faults
+// and write backs so far, the faults since the previous sample and
+// the frames occupied (sim_pag_series.c). The samples go through a
+// buffered soutput, so that they cost a few stores each:
+//
+//   CSV (-s):    "refs,faults,writebacks,window_faults,resident"
+//                and then one line per sample
+//
+//   Binary (-S): the magic bytes SERIES_MAGIC, the interval as a
+//                varint, and then one sample after another: the
+//                references, faults and write backs since the
+//                previous one, and the frames occupied, as varints
+//                (the same ones of a binary trace)
+//
+// The last sample, at the end of the trace, may be shorter.
+
+#define SERIES_MAGIC "\177SER"
+#define SERIES_MAGIC_LEN 4
+
+typedef struct
+{
+    unsigned interval;     // References between samples
+    unsigned countdown;    // References left for the next one
+    unsigned long long refs, faults, writebacks;  // At the previous
+                                                  // sample
+    soutput out;
+}
+sseries;
+
+// Structure with the costs, in nanoseconds, to turn the counters
+// into time: every reference costs an access to memory (preceded
+// by a TLB lookup, and by one more access to the page table on a
+// TLB miss, if there is a TLB model), every fault the time to read
+// the page from the disc, and every page written back when evicted
+// or released the time to write it. The cleaner and readahead work
+// in the background, so they add nothing.
+
+typedef struct
+{
+    double memtime;        // Access to memory
+    double faulttime;      // Service of a page fault (read a page)
+    double writebacktime;  // Write back of a dirty page
+    double tlbtime;        // TLB lookup (0 = no TLB model)
+    double tlbhitratio;    // Hit ratio of the TLB model (the one
+                           // measured if there is a TLB, S->tlb);
+                           // a miss costs the accesses of a walk
+                           // (1, or the ones measured in S->layout)
+}
+scost;
+
+// Arena for the tables of the systems simulated one round after
+// another (-m with -k): chunks of at least ARENA_CHUNK bytes,
+// handed out in order and kept by arena_reset for the next round.
+// Every block comes zeroed, but neither arena_alloc nor a reset
+// clear anything: the tables go back zeroed by free_tables, which
+// only clears what a system wrote (the whole block of a table
+// written in full, only the pages in memory of the page table)
+
+#define ARENA_CHUNK (1<<20)
+#define ARENA_ALIGN 64     // Blocks of different systems never
+                           // share a cache line
+
+typedef struct sarenachunk sarenachunk;
+
+typedef struct
+{
+    sarenachunk * first, * last;
+    sarenachunk * cur;     // Where the next block goes
+}
+sarena;
+
 // Struture that contains the state of the whole system
 
+typedef struct ssystem ssystem;
+
+// Structure with the parts of the simulator that depend on the
+// replacement policy. Each field is the policy-specific part of
+// the function of the same name (NULL = nothing to add); the
+// common part is in sim_pag_common.c
+
 typedef struct
 {
+    const char * name;     // Name in the command line ("LRU"...)
+    char variable;         // 1 = variable allocation: the resident
+                           // set grows and shrinks (up to numframes)
+
+    int (*create_tables) (ssystem * S);  // Allocates S->data
+                                         // (and S->curve; -1 = no memory)
+    int (*know_future) (ssystem * S, const sref * refs,  // The
+                        unsigned n);  // whole trace, before it is
+                                      // simulated (OPT; -1 = no mem.)
+    void (*init_tables) (ssystem * S);
+    void (*reference_page) (ssystem * S, int page, char op);
+    int (*choose_page_to_be_replaced) (ssystem * S, int newpage);
+    void (*replace_page) (ssystem * S, int victim, int newpage);
+    void (*occupy_free_frame) (ssystem * S, int frame, int page);
+    void (*page_fault) (ssystem * S, int page);   // Before taking
+                                                  // a frame for it
+    void (*read_ahead) (ssystem * S, int page);   // The same, for a
+                           // page read ahead (ARC and 2Q, that look
+                           // for it in their ghosts; PFF only counts
+                           // the faults on demand)
+    void (*release_frame) (ssystem * S, int frame, int page);
+    void (*renormalize_timestamps) (ssystem * S);  // After the
+                                    // page table (LRU(t) by frame)
+    void (*reference_run) (ssystem * S, int page, unsigned n);  // n
+                 // more references to the page just referenced, with
+                 // their S->sumresident (NULL = they change nothing
+                 // but the counters; see simulate_runs)
+
+    void (*print_page_table) (ssystem * S);
+    void (*print_frames_table) (ssystem * S);
+    void (*print_replacement_report) (ssystem * S);
+}
+spolicy;
+
+// Replacement policies available
+
+extern const spolicy policy_random, policy_fifo, policy_fifo2ch,
+                     policy_lru, policy_ws, policy_pff,
+                     policy_clock, policy_eclock,
+                     policy_arc, policy_2q, policy_opt;
+
+extern const spolicy * const policies[];   // NULL-terminated
+
+const spolicy * find_policy (const char * name);
+
+struct ssystem
+{
+    // Replacement policy
+    const spolicy * policy;
+
     // Page table (maintained by HW and OS)
     int pagsz;
     int numpags;
-    spage * pgt;
-    int lru;               // Only for LRU replacement
-    unsigned clock;        // Only for LRU(t) replacement
+    spgt * pgt;            // See PAGE and PAGE_SET
+    int lru;               // LRU stack (LRU, WS and PFF)
+    unsigned long long clock;      // Virtual time (LRU(t), WS and
+    unsigned long long clockbase;  // PFF), and origin of the
+                                   // timestamps of the pages
+    char exactlru;         // 1 = keep the LRU stack (S->lru)
+                           // instead of searching timestamps
+    int curvemax;          // >0 = compute the LRU fault curve
+    scurve * curve;        // for 1..curvemax frames (LRU only)
 
     // Frames table (maintained by the OS only)
     int numframes;
     sframe * frt;
     int listfree;
     int listoccupied;      // Only for FIFO and FIFO 2nd ch.
+    int hand;              // Only for CLOCK and enhanced CLOCK
+    void * data;           // Private tables of the policy (ARC, 2Q
+                           // and OPT), a single block freed by
+                           // free_tables
+
+    // Variable allocation (WS and PFF)
+    int window;            // WS: tau; PFF: max. time between faults
+    unsigned long long lastfault;  // PFF: time of the last fault
+    int numresident;       // Frames occupied now
+    int maxresident;       // Peak of numresident
+    unsigned long long sumresident;  // numresident at every ref.
+
+    // Readahead: at a page fault, the next pages are loaded too
+    int readahead;         // Pages read ahead (0 = none); adaptive:
+    char adaptive;         // 1 = only for sequential faults, with
+    int rawindow;          // a window (rawindow) that doubles up to
+    int ralast;            // readahead; ralast = last page loaded by
+                           // the previous fault (-2 = none)
+    unsigned long long numprefetched;       // Pages read ahead
+    unsigned long long numprefetchhits;     // ... and referenced
+                                            // afterwards
+    unsigned long long numprefetchuseless;  // ... and evicted
+                                            // unreferenced
+    int pinfirst, pinlast; // While reading ahead, pages that can't
+                           // be victims (see PINNED)
+
+    // Page cleaner: in the references without a fault, dirty pages
+    // are written back in advance, one per reference, while there
+    // are less than lowwater frames free or clean
+    int lowwater;          // 0 = no cleaner
+    int cleanhand;         // Next frame the cleaner looks at
+    int numdirty;          // Frames with a modified page
+    unsigned long long numcleaned;     // Pages written back by the
+                                       // cleaner
+    unsigned long long numcleanwasted; // ... and modified again
+                                       // afterwards
+    unsigned long long numfaultswait;  // Faults that waited for a
+                                       // write back
+
+    // TLB (tlbentries = 0 -> none)
+    int tlbentries, tlbways;
+    char tlbrandom;        // 1 = random replacement, 0 = LRU
+    stlb * tlb;
+
+    // Layout of the page table (layoutkind = 0 -> no model)
+    char layoutkind;
+    int layoutperlevel;
+    slayout * layout;
+
+    // Cost model (NULL = only counters)
+    const scost * cost;
+
+    // Profile (profile = 1 -> prof), and steps of the searches of
+    // victims so far (entries looked at; the policies that don't
+    // search count as one)
+    char profile;
+    sprofile * prof;
+    unsigned long long victimsteps;
+
+    // Time series (seriesinterval = 0 -> none), in seriesfile, or
+    // in seriesfile.n for the nth system of -m (seriesindex = n)
+    unsigned seriesinterval;
+    char seriesbinary;     // 1 = binary samples, 0 = CSV
+    const char * seriesfile;
+    int seriesindex;
+    sseries * series;
+
+    // Runs of references to the same page (-R): simulated one run
+    // at a time, see simulate_runs
+    char collapse;
+
+    // Where the tables come from (NULL = malloc, freed one by one
+    // by free_tables; otherwise they go with the arena)
+    sarena * arena;
 
     // Trace data
-    int numrefsread;       // Counter of read operations
-    int numrefswrite;      // Counter of write operations
-    int numpagefaults;     // Counter of page faults
-    int numpgwriteback;    // Counter of write back (to disc) ops.
-    int numillegalrefs;    // References out of range
+    unsigned long long numrefsread;     // Counter of read operations
+    unsigned long long numrefswrite;    // Counter of write operations
+    unsigned long long numpagefaults;   // Counter of page faults
+    unsigned long long numpgwriteback;  // Counter of write back (to
+                                        // disc) ops.
+    unsigned long long numillegalrefs;  // References out of range
     char detailed;         // 1 = show step-by-step information
-}
-ssystem;
 
-// Function that initialises the tables
+    // Pseudo-random number generator
+    int randstate[34];
+    int randpos;
+};
+
+// Functions that create, initialise and free the tables
+// (create_tables takes pagsz, numframes and policy from S)
 
+int create_tables (ssystem * S, unsigned totalsz);
 void init_tables (ssystem * S);
+void free_tables (ssystem * S);
+
+// Functions of the arena (sim_pag_arena.c): arena_alloc gives
+// zeroed memory (with A = NULL, straight from calloc), and the
+// releases free it if it didn't come from an arena, or give it
+// back zeroed: arena_release clears the whole block, and
+// arena_release_zeroed expects the caller to have cleared it
+
+void * arena_alloc (sarena * A, size_t bytes);
+void arena_release (sarena * A, void * p);
+void arena_release_zeroed (sarena * A, void * p);
+void arena_reset (sarena * A);   // Everything free again
+void arena_free (sarena * A);
+
+// Pseudo-random numbers for each system (the same sequence as
+// rand() in glibc, but independent for every system)
+
+#define SIM_RAND_MAX 2147483647
+
+void sim_srand (ssystem * S, unsigned seed);
+int sim_rand (ssystem * S);
 
 // Functions that simulate the hardware of the MMU
 
@@ -78,13 +483,180 @@ void reference_page (ssystem * S, int page, char op);
 // Functions that simulate the operating system
 
 void handle_page_fault (ssystem * S, unsigned virtual_addr);
-int choose_page_to_be_replaced (ssystem * S);
+int choose_page_to_be_replaced (ssystem * S, int newpage);
 void replace_page (ssystem * S, int victim, int newpage);
 void occupy_free_frame (ssystem * S, int frame, int page);
+void release_frame (ssystem * S, int page);   // Back to listfree
+void clear_page (ssystem * S, int page);     // Out of memory: all 0
+void read_ahead (ssystem * S, int page);      // After a fault on page
+int prefetched_resident (ssystem * S);        // Still unreferenced
+void clean_page (ssystem * S, int page);      // After a hit on page
+
+// While read_ahead loads the pages after a fault, the fault and
+// the pages after it up to the one being loaded (pinfirst..
+// pinlast) can't be victims: every policy skips them when it
+// chooses one. There are at most numframes-1 of them, so some
+// other page can always leave. Out of read_ahead, pinlast <
+// pinfirst.
+
+#define PINNED(S,p) ((p) >= (S)->pinfirst && (p) <= (S)->pinlast)
+
+// The timestamps of the pages are 32 bits, to keep the page table
+// small, but the clock is 64 bits: they count from S->clockbase,
+// and STAMP(S) is the current time in those terms. When it reaches
+// STAMP_LIMIT, renormalize_timestamps moves the base forward, as
+// far as the oldest timestamp in memory (at least STAMP_LIMIT/2,
+// so pages not referenced for that long end up with 0)
+
+#ifndef STAMP_LIMIT
+#define STAMP_LIMIT 0xC0000000U
+#endif
+
+#define STAMP(S) ((unsigned)((S)->clock - (S)->clockbase))
+
+void renormalize_timestamps (ssystem * S);
+
+// Consecutive references to the same page, collapsed into a run
+// (-R). After the first reference of a run, the page is present
+// and the rest are hits: the second one is simulated as usual
+// (ARC and 2Q count it), and the others at once, with the
+// reference_run of the policy, so that the results are the same
+// as reference by reference. Per reference is the fault, TLB,
+// layout, cleaner, readahead, curve, profile and time series
+// work, so those don't work with runs (nor OPT, which knows every
+// reference). The runs of a block never cross it.
+
+typedef struct
+{
+    int page;
+    unsigned count;        // References (>= 1)
+    unsigned writes;       // How many of them are writes
+}
+spagerun;
+
+// collapse_runs turns n operations into runs of pages of pagsz
+// elements (at most n; the comparisons are left out), and returns
+// how many; simulate_runs simulates them
+
+int collapse_runs (const sref * refs, int n, int pagsz, spagerun * runs);
+void simulate_runs (ssystem * S, const spagerun * runs, int n);
+
+// First present page from page on (S->numpags = none)
+
+int next_present_page (ssystem * S, int page);
+
+// Functions that maintain the LRU stack (S->lru)
+
+void lru_stack_unlink (ssystem * S, int frame);
+void lru_stack_push (ssystem * S, int frame);
+
+// Functions that simulate the TLB (sim_pag_tlb.c)
+
+stlb * tlb_create (sarena * A, int entries, int ways, char random);
+void tlb_reset (stlb * T);
+int tlb_lookup (stlb * T, int page);       // 1 = hit
+void tlb_insert (stlb * T, int page);      // After a miss
+void tlb_invalidate (stlb * T, int page);  // The page leaves memory
+
+// Functions that model the layout of the page table
+// (sim_pag_layout.c)
+
+slayout * layout_create (sarena * A, char kind, int perlevel,
+                         int numpags, int numframes);
+void layout_reset (slayout * L);
+void layout_walk (slayout * L, int page);   // Translation of page
+void layout_map (slayout * L, int page, int frame);    // Loaded
+void layout_unmap (slayout * L, int page, int frame);  // Out
+const char * layout_name (slayout * L);
+
+// Functions that profile the simulation (sim_pag_prof.c)
+
+unsigned long long prof_clock_ns (void);
+sprofile * prof_create (sarena * A);
+void prof_reset (sprofile * P);
+void prof_victim (sprofile * P, unsigned long long steps);
+double prof_ticks_per_ns (const sprofile * P);
+
+// Functions that write the time series (sim_pag_series.c):
+// series_sample when the countdown of a reference reaches 0, and
+// series_close at the end, with the last sample (-1 = some write
+// failed)
+
+sseries * series_create (ssystem * S);
+void series_sample (ssystem * S);
+int series_close (ssystem * S);
+
+// Functions that compute the LRU fault curve (sim_pag_curve.c)
+
+scurve * curve_create (sarena * A, int maxframes, int numpags);
+void curve_reference (scurve * C, int page, char op);
+void curve_print (scurve * C);
+
+// Function that simulates several systems (configurations) over
+// the same trace at once, with numworkers threads
+// (sim_pag_multi.c)
+
+int simulate_systems (strace * T, ssystem * systems, int numsystems,
+                      int numworkers);
+
+// The same, for a whole trace already in memory (OPT)
+
+int simulate_recorded (const sref * refs, unsigned n, ssystem * systems,
+                       int numsystems, int numworkers);
+
+// The same, for operations that don't come from a trace: fill
+// multi_block(M) with up to MULTI_BLOCK operations and hand them
+// with multi_submit (while the next block is being filled, the
+// previous one is simulated; an empty block is nothing to
+// simulate, only multi_finish tells the workers to end)
+
+#define MULTI_BLOCK 65536
+
+typedef struct smulti smulti;
+
+smulti * multi_start (ssystem * systems, int numsystems, int numworkers);
+sref * multi_block (smulti * M);
+void multi_submit (smulti * M, int n);
+void multi_finish (smulti * M);
+
+// Workload mix (-M): several processes, each one with its own
+// trace from gen_trace and its own pages, take turns of quantum
+// references over the same frames (sim_pag_mix.c). With global
+// replacement they are a single system, with the pages of every
+// process one after the other, so the policy chooses among all
+// of them; with local replacement (-d), every process is a system
+// of its own, with its share of the frames. The working set of
+// every process (window S->window, in references of its own) is
+// measured as it goes: their sum bigger than the frames (or, with
+// -d, one of them bigger than its share) means thrashing.
+
+#define MIX_MAX 16         // Processes in a mix
+
+typedef struct
+{
+    char algorithm[4], initialstate[4];
+    int numelem;
+}
+smixspec;
+
+// model has the options of every system (policy, pagsz,
+// numframes...) and no tables
+
+int simulate_mix (const ssystem * model, const smixspec * specs, int n,
+                  int quantum, char local, char binary);
+
+// Functions that turn the counters into time with S->cost: total
+// simulated time of the trace, and effective access time (both in
+// nanoseconds)
+
+double simulated_time (ssystem * S);
+double effective_access_time (ssystem * S);
 
 // Functions that show results
 
 void print_report (ssystem * S);
+void print_summary_header (ssystem * S);   // Columns used by S
+void print_summary (ssystem * S);
 void print_page_table (ssystem * S);
 void print_frames_table (ssystem * S);
 void print_replacement_report (ssystem * S);
@@ -3,6 +3,7 @@
 */
 
 #include <stdlib.h>
+#include <string.h>
 #include "sort.h"
 
 // Sorting by the bubble method
@@ -377,7 +378,7 @@ static unsigned merge_sort_r (void * p, unsigned size,
                               function_write * pwrite)
 {
     unsigned u, v, w, left, right, iter;
-    thing a, b;
+    thing a = 0, b = 0;   // Heads of the halves (read if not empty)
 
     left = size / 2;
     right = size - left;
@@ -569,3 +570,175 @@ static unsigned my_random (unsigned from, unsigned size)
 }
 
 
+
+// Functions that prepare the data according to
+// different criteria:
+
+void ascending_order (thing A[], unsigned size)
+{
+    unsigned u;
+
+    for (u=0; u<size; u++)
+        A[u] = u;
+}
+
+void descending_order (thing A[], unsigned size)
+{
+    unsigned u;
+
+    for (u=0; u<size; u++)
+        A[u] = size-u-1;
+}
+
+void random_order (thing A[], unsigned size)
+{
+    unsigned u, n;
+    thing tmp;
+
+    srand (0);
+
+    for (u=0; u<5; u++)
+        rand ();
+
+    ascending_order (A, size);
+
+    for (u=0; u<size-1; u++)
+    {
+        n = 1 + u + (unsigned)(rand() * (size-u-1.0) / RAND_MAX);
+
+        if (n>size-1)
+            n = size-1;
+
+        if (n!=u)
+        {
+            tmp = A[n];
+            A[n] = A[u];
+            A[u] = tmp;
+        }
+    }
+}
+
+// Functions that find an algorithm or an initial state
+// by its name:
+
+static const struct
+{
+    function_sort * pfun;
+    const char * name;
+}
+sorts[] = { { bubble_sort, "BUB" },
+            { insertion_sort, "INS" },
+            { selection_sort, "SEL" },
+            { heap_sort, "HEA" },
+            { comb_sort, "COM" },
+            { merge_sort, "MER" },
+            { quick_sort, "QUI" },
+            { quick_sort_pa, "QRP" },
+            { NULL, NULL } };
+
+static const struct
+{
+    function_prepare_data * pfun;
+    const char * name;
+}
+prepares[] = { { ascending_order, "ASC" },
+               { descending_order, "DES" },
+               { random_order, "RAN" },
+               { NULL, NULL } };
+
+function_sort * find_sort (const char * name)
+{
+    int u;
+
+    for (u=0; sorts[u].pfun; u++)
+        if (!strcmp(name,sorts[u].name))
+            break;
+
+    return sorts[u].pfun;
+}
+
+function_prepare_data * find_prepare (const char * name)
+{
+    int u;
+
+    for (u=0; prepares[u].pfun; u++)
+        if (!strcmp(name,prepares[u].name))
+            break;
+
+    return prepares[u].pfun;
+}
+
+unsigned sort_total_size (function_sort * psort, unsigned size)
+{
+    return psort==merge_sort ? size*2 : size;
+}
+
+// Sorts run inside the process: the same as gen_trace, but
+// every operation goes straight to a function instead of
+// being printed in a trace (and parsed again by the reader)
+
+typedef struct
+{
+    thing * pdata;                   // Array with data to be sorted
+    function_operation * poperation; // Where the operations go
+    void * arg;                      // (and its first parameter)
+}
+sinprocess;
+
+static thing inprocess_read (void * p, unsigned pos)
+{
+    sinprocess * pc = (sinprocess*) p;
+
+    pc->poperation (pc->arg, 'R', pos);
+
+    return pc->pdata[pos];
+}
+
+static void inprocess_write (void * p, unsigned pos, thing value)
+{
+    sinprocess * pc = (sinprocess*) p;
+
+    pc->poperation (pc->arg, 'W', pos);
+
+    pc->pdata[pos] = value;
+}
+
+static int inprocess_lesser_than (void * p, thing a, thing b)
+{
+    sinprocess * pc = (sinprocess*) p;
+
+    pc->poperation (pc->arg, 'C', 0);
+
+    return a < b;
+}
+
+int sort_in_process (function_sort * psort,
+                     function_prepare_data * pprepare,
+                     unsigned size, function_operation * poperation,
+                     void * arg)
+{
+    sinprocess C;
+    unsigned u;
+
+    C.pdata = (thing*) malloc (sort_total_size(psort,size)*sizeof(thing));
+    C.poperation = poperation;
+    C.arg = arg;
+
+    if (!C.pdata)
+        return -1;
+
+    // Generate data in specified initial state
+    pprepare (C.pdata, size);
+
+    // Sort data with specified algorithm
+    psort (&C, size, inprocess_lesser_than,
+           inprocess_read, inprocess_write);
+
+    for (u=0; u<size-1; u++)
+        if (C.pdata[u+1] < C.pdata[u])
+            break;
+
+    free (C.pdata);
+
+    return u<size-1 ? -1 : 0;
+}
@@ -33,4 +33,36 @@ typedef unsigned function_sort(void *, unsigned size,
 function_sort bubble_sort, insertion_sort, selection_sort, heap_sort, comb_sort,
     merge_sort, quick_sort, quick_sort_pa;
 
+// Type of functions that prepare the data according to
+// different criteria, and the criteria:
+
+typedef void function_prepare_data(thing A[], unsigned size);
+
+function_prepare_data ascending_order, descending_order, random_order;
+
+// Functions that find an algorithm (BUB, INS, SEL, HEA, COM,
+// MER, QUI or QRP) or an initial state (ASC, DES or RAN) by
+// its name (NULL if there is no such one):
+
+function_sort *find_sort(const char *name);
+function_prepare_data *find_prepare(const char *name);
+
+// Total # of elements used by an algorithm (double in MER):
+
+unsigned sort_total_size(function_sort *psort, unsigned size);
+
+// Type of function that receives the operations of a sort run
+// inside the process ('R'ead, 'W'rite or 'C'omparison, and the
+// element read or written), instead of a trace:
+
+typedef void function_operation(void *, char op, unsigned pos);
+
+// Function that prepares and sorts size elements, handing every
+// operation to poperation as soon as it's done (0 if the result
+// is sorted, -1 otherwise):
+
+int sort_in_process(function_sort *psort, function_prepare_data *pprepare,
+                    unsigned size, function_operation *poperation,
+                    void *arg);
+
 #endif  // SORT_H_
@@ -0,0 +1,402 @@
+/*
+    trace.c
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "trace.h"
+
+#define TRACE_BUFSZ 65536
+
+// Functions that get the raw bytes of the trace
+
+static int refill (strace * T)
+{
+    if (T->end)
+        return -1;
+
+    T->len = fread (T->buf, 1, TRACE_BUFSZ, T->pipe);
+    T->pos = 0;
+
+    if (T->len < TRACE_BUFSZ)
+        T->end = 1;
+
+    return T->len ? T->buf[T->pos++] : -1;
+}
+
+#define GETC(T) ((T)->pos<(T)->len ? (T)->buf[(T)->pos++] : refill(T))
+
+static int skip_spaces (strace * T)
+{
+    int c;
+
+    do
+        c = GETC (T);
+    while (c==' ' || c=='\n' || c=='\t' || c=='\r');
+
+    return c;
+}
+
+static int get_number (strace * T, unsigned * pu)
+{
+    int c, i, shift;
+    unsigned u;
+
+    if (T->binary)
+    {
+        for (u=0, shift=0, i=0; i<5; i++, shift+=7)
+        {
+            if ((c=GETC(T)) < 0)
+                return -1;
+
+            u |= (unsigned)(c&0x7F) << shift;
+
+            if (!(c&0x80))
+            {
+                *pu = u;
+                return 0;
+            }
+        }
+
+        return -1;
+    }
+
+    c = skip_spaces (T);
+
+    if (c<'0' || c>'9')
+        return -1;
+
+    for (u=0; c>='0' && c<='9'; c=GETC(T))
+        u = u*10 + (c-'0');
+
+    if (c>=0)          // Give back the character
+        T->pos --;     // following the number
+
+    *pu = u;
+    return 0;
+}
+
+// Functions that read a trace
+
+static int read_header (strace * T)
+{
+    unsigned char magic[TRACE_MAGIC_LEN];
+    int c, i;
+
+    // Find out the format from the first byte
+    c = GETC (T);
+    T->binary = c==TRACE_MAGIC[0];
+
+    if (T->binary)
+    {
+        magic[0] = c;
+
+        for (i=1; i<TRACE_MAGIC_LEN && (c=GETC(T))>=0; i++)
+            magic[i] = c;
+
+        if (i<TRACE_MAGIC_LEN ||
+            memcmp(magic,TRACE_MAGIC,TRACE_MAGIC_LEN))
+            return -1;
+    }
+    else
+    {
+        if (c>=0)
+            T->pos --;     // Give it back
+
+        if (skip_spaces(T)!='T')
+            return -1;
+    }
+
+    // Read total # of elements to be sorted
+    return get_number (T, &T->totalsz);
+}
+
+// A trace without a valid header: nothing is left open (a later
+// trace_close finds nothing to close)
+
+static int open_failed (strace * T)
+{
+    trace_close (T);
+    return -1;
+}
+
+int trace_open (strace * T, const char * command)
+{
+    memset (T, 0, sizeof(*T));
+
+    T->buf = (unsigned char*) malloc (TRACE_BUFSZ);
+
+    if (!T->buf)
+    {
+        fprintf (stderr, "ERROR: not enough dynamic memory\n");
+        return -1;
+    }
+
+    // Invoke gen_trace and open a pipe to read
+    // its standard output ("r" stands for read)
+    T->pipe = popen (command, "r");
+
+    if (!T->pipe)
+    {
+        perror ("ERROR while starting gen_trace");
+        free (T->buf);
+        T->buf = NULL;
+        return -1;
+    }
+
+    return read_header (T)<0 ? open_failed (T) : 0;
+}
+
+int trace_map (strace * T, const char * path)
+{
+    struct stat st;
+    void * map;
+    int fd;
+
+    memset (T, 0, sizeof(*T));
+
+    fd = open (path, O_RDONLY);
+
+    if (fd<0 || fstat(fd,&st)<0)
+    {
+        perror (path);
+
+        if (fd>=0)
+            close (fd);
+
+        return -1;
+    }
+
+    map = st.st_size ? mmap (NULL, st.st_size, PROT_READ,
+                             MAP_PRIVATE, fd, 0)
+                     : MAP_FAILED;
+    close (fd);   // The mapping keeps the file referenced
+
+    if (map==MAP_FAILED)
+    {
+        fprintf (stderr, "ERROR: cannot map trace file %s\n", path);
+        return -1;
+    }
+
+    madvise (map, st.st_size, MADV_SEQUENTIAL);
+
+    // The whole file is one single block: refill never
+    // gets called, nothing is copied
+    T->mapped = 1;
+    T->buf = (unsigned char*) map;
+    T->len = st.st_size;
+    T->end = 1;
+
+    return read_header (T)<0 ? open_failed (T) : 0;
+}
+
+int trace_read (strace * T, sref * refs, int max)
+{
+    int n, c;
+
+    if (T->done)
+        return 0;
+
+    for (n=0; n<max; n++)
+    {
+        c = T->binary ? GETC(T) : skip_spaces(T);
+
+        if (c=='R' || c=='W')                // If R/W,
+        {                                    // take element
+            refs[n].op = c;                  // number
+            if (get_number(T,&refs[n].elem)<0)
+                return -1;
+        }
+        else if (c=='C')         // 'C'omparison -> go on
+            refs[n].op = c;
+        else if (c=='S')         // 'S'orted -> end
+        {
+            T->done = 1;
+            break;
+        }
+        else                     // 'O'ut of order (or
+            return -1;           // something else) -> error
+    }
+
+    return n;
+}
+
+int trace_close (strace * T)
+{
+    int ok = 1;
+
+    // Wait until gen_trace ends and close
+    if (T->pipe && pclose(T->pipe)==-1)
+        ok = 0;
+
+    if (T->mapped)
+        munmap (T->buf, T->len);
+    else
+        free (T->buf);
+
+    T->buf = NULL;
+    T->pipe = NULL;
+    T->mapped = 0;
+
+    return ok ? 0 : -1;
+}
+
+// Buffered output
+
+int output_create (soutput * O, const char * path)
+{
+    memset (O, 0, sizeof(*O));
+
+    O->fd = path ? open (path, O_WRONLY|O_CREAT|O_TRUNC, 0666) : 1;
+
+    if (O->fd<0)
+    {
+        perror (path);
+        return -1;
+    }
+
+    O->buf = (unsigned char*) malloc (OUTPUT_BUFSZ);
+
+    if (!O->buf)
+    {
+        fprintf (stderr, "ERROR: not enough dynamic memory\n");
+
+        if (path)
+            close (O->fd);
+
+        return -1;
+    }
+
+    return 0;
+}
+
+void output_flush (soutput * O)
+{
+    size_t done;
+    ssize_t n;
+
+    for (done=0; done<O->len && !O->error; done+=n)
+    {
+        n = write (O->fd, O->buf+done, O->len-done);
+
+        if (n<0 && errno==EINTR)
+            n = 0;
+        else if (n<=0)
+            O->error = 1;
+    }
+
+    O->len = 0;
+}
+
+int output_close (soutput * O)
+{
+    output_flush (O);
+
+    if (O->fd!=1 && close(O->fd)<0)
+        O->error = 1;
+
+    free (O->buf);
+    O->buf = NULL;
+
+    return O->error ? -1 : 0;
+}
+
+void output_bytes (soutput * O, const void * p, size_t n)
+{
+    const unsigned char * b = (const unsigned char*) p;
+    size_t chunk;
+
+    while (n>0)
+    {
+        if (O->len==OUTPUT_BUFSZ)
+            output_flush (O);
+
+        chunk = OUTPUT_BUFSZ-O->len < n ? OUTPUT_BUFSZ-O->len : n;
+        memcpy (O->buf+O->len, b, chunk);
+        O->len += chunk;
+        b += chunk;
+        n -= chunk;
+    }
+}
+
+void output_number (soutput * O, unsigned long long u)
+{
+    unsigned char digits[20];
+    int n = 0;
+
+    do                          // From the last digit
+        digits[sizeof(digits)-(++n)] = '0' + u%10;
+    while ((u/=10) != 0);
+
+    output_bytes (O, digits+sizeof(digits)-n, n);
+}
+
+void output_varint (soutput * O, unsigned long long u)
+{
+    while (u>=0x80)
+    {
+        output_char (O, (u&0x7F)|0x80);
+        u >>= 7;
+    }
+
+    output_char (O, u);
+}
+
+// Functions that write a trace
+
+void trace_put_header (soutput * O, unsigned totalsz)
+{
+    if (O->binary)
+    {
+        output_bytes (O, TRACE_MAGIC, TRACE_MAGIC_LEN);
+        output_varint (O, totalsz);
+    }
+    else
+    {
+        output_bytes (O, " T", 2);
+        output_number (O, totalsz);
+        output_char (O, '\n');
+    }
+}
+
+void trace_put_op (soutput * O, char op, unsigned elem)
+{
+    if (O->binary)
+    {
+        output_char (O, op);
+
+        if (op=='R' || op=='W')
+            output_varint (O, elem);
+
+        return;
+    }
+
+    output_char (O, ' ');
+    output_char (O, op);
+
+    if (op=='R' || op=='W')
+        output_number (O, elem);
+
+    if (O->width && ++O->column==O->width)
+    {
+        output_char (O, '\n');
+        O->column = 0;
+    }
+}
+
+void trace_put_end (soutput * O, int sorted)
+{
+    if (O->binary)
+        output_char (O, sorted ? 'S' : 'O');
+    else if (sorted)
+        output_bytes (O, " Sorted ;-)\n", 12);
+    else
+        output_bytes (O, " Out of order :-(\n", 18);
+}
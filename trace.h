@@ -0,0 +1,110 @@
+/*
+    trace.h
+*/
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdio.h>
+
+// A trace is the list of operations performed by gen_trace.
+// It can travel in two formats:
+//
+//   ASCII (default):  " T8\n R0 W4 R1 C ... Sorted ;-)"
+//
+//   Binary (compact): the magic bytes TRACE_MAGIC, the total
+//                     size as a varint, and then one tag byte
+//                     per operation ('R', 'W', 'C', 'S' or 'O',
+//                     the same letters as in ASCII). 'R' and 'W'
+//                     are followed by the element number as a
+//                     varint (7 bits per byte, least significant
+//                     group first, high bit = more bytes follow).
+
+#define TRACE_MAGIC "\177TRC"
+#define TRACE_MAGIC_LEN 4
+
+// Number of operations handed out by trace_read at once
+
+#define TRACE_BLOCK 4096
+
+// One elementary operation of the trace
+
+typedef struct
+{
+    char op;              // 'R'ead, 'W'rite or 'C'omparison
+    unsigned elem;        // Element read/written (R/W only)
+}
+sref;
+
+// State of a trace being read
+
+typedef struct
+{
+    FILE * pipe;          // Channel with gen_trace
+    char mapped;          // 1 = buf is a trace file mmap'ed
+    char binary;          // 1 = compact binary format
+    char end;             // 1 = no more input after buf
+    char done;            // 1 = 'S'orted already reached
+    unsigned char * buf;  // Block of raw input
+    size_t len, pos;      // Bytes in buf and next one to decode
+    unsigned totalsz;     // Total # of elements (double in MER)
+}
+strace;
+
+// Functions that read a trace. trace_open runs the command
+// and reads the header (the total size); trace_map does the
+// same with a trace file stored by gen_trace -o, mapping it
+// in memory so that it is decoded in place; trace_read decodes
+// up to max operations and returns how many it got, 0 once
+// the trace has ended with 'S'orted, or -1 on error.
+
+int trace_open (strace *, const char * command);
+int trace_map (strace *, const char * path);
+int trace_read (strace *, sref * refs, int max);
+int trace_close (strace *);
+
+// Buffered output: the bytes are gathered in a big buffer and
+// go out with a few write(2) calls, with no stdio in between,
+// and the numbers are formatted by hand
+
+#define OUTPUT_BUFSZ (256*1024)
+
+typedef struct
+{
+    int fd;               // Where the bytes go
+    char binary;          // 1 = trace in compact binary format
+    int width;            // Operations per line (0 = no newlines)
+    int column;           // Operations in the current line
+    int error;            // 1 = some write failed
+    unsigned char * buf;  // Bytes not written yet
+    size_t len;           // How many
+}
+soutput;
+
+// output_create opens (creates) the file at path, or uses the
+// standard output if path is NULL; output_close writes what is
+// left and closes it (not the standard output), and returns -1
+// if anything failed on the way
+
+int output_create (soutput *, const char * path);
+int output_close (soutput *);
+
+void output_flush (soutput *);
+void output_bytes (soutput *, const void * p, size_t n);
+void output_number (soutput *, unsigned long long u);
+void output_varint (soutput *, unsigned long long u);  // As in a
+                                                      // binary trace
+
+#define output_char(O,c) \
+    ((O)->len<OUTPUT_BUFSZ ? (void)((O)->buf[(O)->len++] = (c)) \
+                          : (output_flush(O), (void)((O)->buf[(O)->len++] = (c))))
+
+// Functions that write a trace (ASCII, with width operations per
+// line, or binary if O->binary): header, operations, and the end
+// ("Sorted" or "Out of order")
+
+void trace_put_header (soutput *, unsigned totalsz);
+void trace_put_op (soutput *, char op, unsigned elem);
+void trace_put_end (soutput *, int sorted);
+
+#endif  // TRACE_H_